@@ -0,0 +1,70 @@
+/*
+ * BitGrid.cpp
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include "stdafx.h"
+#include "BitGrid.h"
+
+BitGrid::BitGrid(const std::vector<bool>& map, int width, int height)
+: m_width(width), m_height(height)
+{
+	// One extra column on each side and one extra row above and below for the wall border
+	m_wordsPerRow = (m_width + 2 + 63) / 64;
+
+	int numWords = (m_height + 2) * m_wordsPerRow;
+	m_bits = new uint64_t[numWords];
+	memset(m_bits, 0, sizeof(uint64_t) * numWords);
+
+	for (int r = 0; r < m_height; ++r)
+	{
+		uint64_t* row = m_bits + ((r + 1) * m_wordsPerRow);
+		for (int c = 0; c < m_width; ++c)
+		{
+			if (map[c + (r * m_width)])
+			{
+				unsigned int bit = c + 1;
+				row[bit >> 6] |= (uint64_t)1 << (bit & 63);
+			}
+		}
+	}
+}
+
+BitGrid::~BitGrid()
+{
+	delete[] m_bits;
+}
@@ -0,0 +1,79 @@
+/*
+ * BitGrid.h
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#pragma once
+#include <vector>
+#include <stdint.h>
+
+// Immutable, word-packed map of the grid (a set bit is an empty cell).
+// A border of walls surrounds the map, so rows -1 and height, and columns -1
+// and width, can be read without any bounds checks.
+// Built once per map and shared by the preprocessing and the search.
+
+class BitGrid
+{
+public:
+	BitGrid(const std::vector<bool>& map, int width, int height);
+	~BitGrid();
+
+	inline int GetWidth() const { return m_width; }
+	inline int GetHeight() const { return m_height; }
+
+	// Valid for -1 <= r <= height and -1 <= c <= width
+	inline bool IsEmpty(int r, int c) const
+	{
+		unsigned int bit = c + 1;
+		return ((GetRow(r)[bit >> 6] >> (bit & 63)) & 1) != 0;
+	}
+	inline bool IsWall(int r, int c) const { return !IsEmpty(r, c); }
+
+	// Packed row r (from -1 to height), where bit (c + 1) holds column c.
+	// Bit 0 and every bit past the last column are walls.
+	inline const uint64_t* GetRow(int r) const { return m_bits + ((r + 1) * m_wordsPerRow); }
+	inline int GetWordsPerRow() const { return m_wordsPerRow; }
+
+private:
+	int m_width, m_height;
+	int m_wordsPerRow;
+	uint64_t* m_bits;
+
+	// Not copyable, share it by pointer instead
+	BitGrid(const BitGrid&);
+	BitGrid& operator=(const BitGrid&);
+};
@@ -40,65 +40,61 @@
 #include "stdafx.h"
 #include "BucketPriorityQueue.h"
 #include "UnsortedPriorityQueue.h"
+#include <cassert>
 
-BucketPriorityQueue::BucketPriorityQueue(int buckets, int arraySize, unsigned int division)
+BucketPriorityQueue::BucketPriorityQueue(unsigned int maxEdgeCost, unsigned int division, int arraySize, unsigned int* openListIndex)
 {
-	m_numBuckets = buckets;
 	m_division = division;
 
-	Reset();
-
-	// Allocate a bunch of free buckets
-	m_maxFreeBuckets = 200;
-	m_nextFreeBucket = 0;
-	m_freeBuckets = new UnsortedPriorityQueue*[m_maxFreeBuckets];
-	for (int m = 0; m < m_maxFreeBuckets; m++)
+	// Open nodes span at most one maximum edge cost, plus one bin for rounding
+	unsigned int binsNeeded = (maxEdgeCost / division) + 2;
+	m_numBuckets = 1;
+	while (m_numBuckets < binsNeeded)
 	{
-		m_freeBuckets[m] = new UnsortedPriorityQueue(arraySize);
+		m_numBuckets <<= 1;
 	}
+	m_binMask = m_numBuckets - 1;
 
-	// Allocate bucket slots
+	// Allocate the ring of buckets
 	m_bin = new UnsortedPriorityQueue*[m_numBuckets];
-	for (int m = 0; m < m_numBuckets; m++)
+	for (unsigned int m = 0; m < m_numBuckets; m++)
 	{
-		m_bin[m] = 0;
+		m_bin[m] = new UnsortedPriorityQueue(arraySize, openListIndex);
 	}
+
+	Reset();
 }
 
 BucketPriorityQueue::~BucketPriorityQueue()
 {
-	for (int m = 0; m < m_maxFreeBuckets; m++)
+	for (unsigned int m = 0; m < m_numBuckets; m++)
 	{
-		if(m_freeBuckets[m] != 0)
-		{
-			delete m_freeBuckets[m];
-		}
+		delete m_bin[m];
 	}
 
-	delete[] m_freeBuckets;
+	delete[] m_bin;
+}
 
-	for (int m = 0; m < m_numBuckets; m++)
+void BucketPriorityQueue::Reset()
+{
+	for (unsigned int m = 0; m < m_numBuckets; m++)
 	{
-		if(m_bin[m] != 0)
-		{
-			delete m_bin[m];
-		}
+		m_bin[m]->Reset();
 	}
 
-	delete[] m_bin;
+	m_lowestNonEmptyBin = EMPTY_BIN;
+	m_numNodesTracked = 0;
 }
 
-void BucketPriorityQueue::Push(DijkstraPathfindingNode* node)
+void BucketPriorityQueue::Push(unsigned int node, PathCost cost)
 {
 	m_numNodesTracked++;
-	int index = GetBinIndex(node->m_givenCost);
+	PathCost index = GetBinIndex(cost);
 
-	if(m_bin[index] == 0)
-	{
-		m_bin[index] = m_freeBuckets[m_nextFreeBucket++];
-	}
+	// A node more than one ring away would alias onto a live bin
+	assert(m_lowestNonEmptyBin == EMPTY_BIN || index - m_lowestNonEmptyBin < m_numBuckets);
 
-	m_bin[index]->Push(node);
+	GetBin(index)->Push(node, cost);
 
 	if (index < m_lowestNonEmptyBin)
 	{
@@ -106,58 +102,36 @@ void BucketPriorityQueue::Push(DijkstraPathfindingNode* node)
 	}
 }
 
-DijkstraPathfindingNode* BucketPriorityQueue::Pop(void)
+unsigned int BucketPriorityQueue::Pop(void)
 {
-	DijkstraPathfindingNode* node = m_bin[m_lowestNonEmptyBin]->Pop();
+	UnsortedPriorityQueue* bin = GetBin(m_lowestNonEmptyBin);
+	unsigned int node = bin->Pop();
 	m_numNodesTracked--;
 
-	if(m_bin[m_lowestNonEmptyBin]->Empty(node->m_iteration))
-	{
-		m_freeBuckets[--m_nextFreeBucket] = m_bin[m_lowestNonEmptyBin];
-		m_bin[m_lowestNonEmptyBin] = 0;
-	}
-
 	if (m_numNodesTracked > 0)
 	{
-		// Find the next non-empty bin
-		for (m_lowestNonEmptyBin; m_lowestNonEmptyBin < m_numBuckets; m_lowestNonEmptyBin++)
+		// Find the next non-empty bin (always within one trip around the ring)
+		while (bin->Empty())
 		{
-			if (m_bin[m_lowestNonEmptyBin] != 0 && 
-				!m_bin[m_lowestNonEmptyBin]->Empty(node->m_iteration))
-			{
-				break;
-			}
+			bin = GetBin(++m_lowestNonEmptyBin);
 		}
 	}
 	else
 	{
-		m_lowestNonEmptyBin = m_numBuckets;
+		m_lowestNonEmptyBin = EMPTY_BIN;
 	}
 
 	return node;
 }
 
-void BucketPriorityQueue::DecreaseKey(DijkstraPathfindingNode* node, unsigned int lastCost)
+void BucketPriorityQueue::DecreaseKey(unsigned int node, PathCost lastCost, PathCost cost)
 {
 	// Remove node
-	int index = GetBinIndex(lastCost);
-	m_bin[index]->Remove(node);
-
-	if(m_bin[index]->Empty(node->m_iteration))
-	{
-		m_freeBuckets[--m_nextFreeBucket] = m_bin[index];
-		m_bin[index] = 0;
-	}
+	GetBin(GetBinIndex(lastCost))->Remove(node);
 
 	// Push node
-	index = GetBinIndex(node->m_givenCost);
-
-	if(m_bin[index] == 0)
-	{
-		m_bin[index] = m_freeBuckets[m_nextFreeBucket++];
-	}
-
-	m_bin[index]->Push(node);
+	PathCost index = GetBinIndex(cost);
+	GetBin(index)->Push(node, cost);
 
 	if (index < m_lowestNonEmptyBin)
 	{
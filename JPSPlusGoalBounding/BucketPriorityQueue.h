@@ -38,38 +38,38 @@
  */ 
 
 #pragma once
+#include "MapTypes.h"
 #include "UnsortedPriorityQueue.h"
 
-// This data structure is dangerous since there are no safeguards if the max size is exceeded.
-// However, any method to detect a problem and deal with it gracefully will sacrifice speed.
-// The number of buckets can be reduced if the maximum final cost is known to be lower (significant memory savings)
+// Circular bucket open list (Dial's algorithm) for a Dijkstra search with bounded edge costs.
+// Because every open node has a cost within one maximum edge cost of the cheapest open node,
+// only a small ring of buckets is ever in use at once. Bucket indices are absolute (cost / division)
+// and are wrapped into the ring, so memory stays fixed regardless of path length or map size.
+// Buckets grow on demand, so there is no maximum node count to exceed.
 // In this code base, this is only used by the Dijkstra floodfill for Goal Bounding preprocessing.
 
 class BucketPriorityQueue
 {
 public:
-	BucketPriorityQueue(int buckets, int arraySize, unsigned int division);
+	BucketPriorityQueue(unsigned int maxEdgeCost, unsigned int division, int arraySize, unsigned int* openListIndex);
 	~BucketPriorityQueue();
 
-	inline void SetBaseCost(unsigned int baseCost) { m_baseCost = baseCost; }
-	inline void Reset() { m_lowestNonEmptyBin = m_numBuckets; m_numNodesTracked = 0; m_baseCost = 0; }
+	void Reset();
 	inline bool Empty() { return m_numNodesTracked == 0; }
-	void Push(DijkstraPathfindingNode* node);
-	DijkstraPathfindingNode* Pop(void);
-	void DecreaseKey(DijkstraPathfindingNode* node, unsigned int lastCost);
+	void Push(unsigned int node, PathCost cost);
+	unsigned int Pop(void);
+	void DecreaseKey(unsigned int node, PathCost lastCost, PathCost cost);
 
 private:
-	int m_numBuckets;
-	int m_lowestNonEmptyBin;
+	static const PathCost EMPTY_BIN = ~(PathCost)0;
+
+	unsigned int m_numBuckets;	// Power of two
+	unsigned int m_binMask;
+	PathCost m_lowestNonEmptyBin;	// Absolute, like the costs
 	int m_numNodesTracked;
 	unsigned int m_division;
-	unsigned int m_baseCost;
 	UnsortedPriorityQueue** m_bin;
 
-	int m_maxFreeBuckets;
-	int m_nextFreeBucket;
-	UnsortedPriorityQueue** m_freeBuckets;
-
-	inline int GetBinIndex(unsigned int cost) { return ((cost - m_baseCost) / m_division); }
+	inline PathCost GetBinIndex(PathCost cost) { return cost / m_division; }
+	inline UnsortedPriorityQueue* GetBin(PathCost index) { return m_bin[index & m_binMask]; }
 };
-
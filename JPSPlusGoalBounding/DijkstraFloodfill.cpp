@@ -39,6 +39,7 @@
 
 #include "stdafx.h"
 #include "DijkstraFloodfill.h"
+#include <malloc.h>
 
 #define ONLY_VISIT_REASONABLE_NEIGHBORS	// 3% to 17% speed-up
 
@@ -47,53 +48,66 @@
 #define FIXED_POINT_ONE FIXED_POINT_MULTIPLIER
 #define FIXED_POINT_SQRT_2 141421
 
-typedef const void (DijkstraFloodfill::*DijkstraFloodFunctionPointer)(DijkstraPathfindingNode * currentNode);
+typedef const void (DijkstraFloodfill::*DijkstraFloodFunctionPointer)(unsigned int currentNode);
 
-DijkstraFloodfill::DijkstraFloodfill(int width, int height, std::vector<bool> map, DistantJumpPoints** distantJumpPointMap)
-: m_width(width), m_height(height), m_map(map)
+DijkstraFloodfill::DijkstraFloodfill(const BitGrid* grid, DistantJumpPoints* distantJumpPointMap)
+: m_width(grid->GetWidth()), m_height(grid->GetHeight()), m_grid(grid)
 {
 	m_currentIteration = 1;
 
-#ifdef USE_FAST_OPEN_LIST
-	// Number of buckets
-	const int numberOfBuckets = 300000;	// Must be no smaller than longest path divided by "division" 
-	const int nodesInEachBucket = 1000;
-	const int division = 10000;
-	m_fastOpenList = new BucketPriorityQueue(numberOfBuckets, nodesInEachBucket, division);
-#endif
-
 	// Initialize nodes
-	InitArray(m_mapNodes, m_width, m_height);
+	int numNodes = m_width * m_height;
+	InitArray(m_givenCost, numNodes);
+	InitArray(m_iteration, numNodes);
+	InitArray(m_openListIndex, numNodes);
+	InitArray(m_directionFromStart, numNodes);
+	InitArray(m_directionFromParent, numNodes);
+	InitArray(m_blockedDirectionBitfield, numNodes);
+	InitArray(m_listStatus, numNodes);
+
 	for (int r = 0; r<m_height; r++)
 	{
 		for (int c = 0; c<m_width; c++)
 		{
-			DijkstraPathfindingNode& node = m_mapNodes[r][c];
-			node.m_row = r;
-			node.m_col = c;
-			node.m_iteration = 0;
-			node.m_listStatus = PathfindingNode::OnNone;
-			node.m_blockedDirectionBitfield = 0;
+			unsigned int node = c + (r * m_width);
+			m_listStatus[node] = PathfindingNode::OnNone;
 
 			for (int i = 0; i < 8; i++)
 			{
 				// Detect invalid movement from jump distances
 				// (jump distance of zero is invalid movement)
-				if (distantJumpPointMap[r][c].jumpDistance[i] == 0)
+				if (distantJumpPointMap[r * m_width + c].jumpDistance[i] == 0)
 				{
-					node.m_blockedDirectionBitfield |= (1 << i);
+					m_blockedDirectionBitfield[node] |= (1 << i);
 				}
 			}
 		}
 	}
+
+#ifdef USE_FAST_OPEN_LIST
+	// Only a ring of (FIXED_POINT_SQRT_2 / division) buckets is live at once
+	const int nodesInEachBucket = 1000;	// Initial size, buckets grow as needed
+	const int division = 10000;
+	m_fastOpenList = new BucketPriorityQueue(FIXED_POINT_SQRT_2, division, nodesInEachBucket, m_openListIndex);
+#else
+	m_openList = new IndexedHeap(3000, m_openListIndex);
+#endif
 }
 
 DijkstraFloodfill::~DijkstraFloodfill()
 {
-	DestroyArray(m_mapNodes);
+	DestroyArray(m_givenCost);
+	DestroyArray(m_iteration);
+	DestroyArray(m_openListIndex);
+	DestroyArray(m_directionFromStart);
+	DestroyArray(m_directionFromParent);
+	DestroyArray(m_blockedDirectionBitfield);
+	DestroyArray(m_listStatus);
 
 #ifdef USE_FAST_OPEN_LIST
 	delete m_fastOpenList;
+#else
+	delete m_openList;
 #endif
 }
 
@@ -113,183 +127,175 @@ void DijkstraFloodfill::Flood(int r, int c)
 #ifdef USE_FAST_OPEN_LIST
 	m_fastOpenList->Reset();
 #else
-	m_openList.reset();
-	m_openList.reserve(3000);
+	m_openList->Reset();
 #endif
 
-	if (IsEmpty(r, c))
+	if (m_grid->IsEmpty(r, c))
 	{	
 		// Begin with starting node
-		DijkstraPathfindingNode* node = &m_mapNodes[r][c];
-		node->m_parent = NULL;
-		node->m_directionFromStart = 255;
-		node->m_directionFromParent = 255;
-		node->m_givenCost = 0;
-		node->m_iteration = m_currentIteration;
-		node->m_listStatus = PathfindingNode::OnOpen;
+		unsigned int node = c + (r * m_width);
+		m_directionFromStart[node] = 255;
+		m_directionFromParent[node] = 255;
+		m_givenCost[node] = 0;
+		m_iteration[node] = m_currentIteration;
+		m_listStatus[node] = PathfindingNode::OnOpen;
 
 		// Explore outward in all directions on the starting node
 		Explore_AllDirectionsWithChecks(node);
 
-		node->m_listStatus = PathfindingNode::OnClosed;
+		m_listStatus[node] = PathfindingNode::OnClosed;
 	}
 
 #ifdef USE_FAST_OPEN_LIST
 	while (!m_fastOpenList->Empty())
 #else
-	while (!m_openList.empty())
+	while (!m_openList->Empty())
 #endif
 	{
 
 #ifdef USE_FAST_OPEN_LIST
-		DijkstraPathfindingNode* currentNode = m_fastOpenList->Pop();
+		unsigned int currentNode = m_fastOpenList->Pop();
 #else
-		DijkstraPathfindingNode* currentNode = m_openList.remove();
+		unsigned int currentNode = m_openList->Pop();
 #endif
 
 		// Explore nodes based on the parent and surrounding walls.
 		// This must be in the search style of JPS+ in order to produce
 		// the correct data for JPS+. If goal bounding is used for regular
 		// A*, then this search would need to mimic regular A*.
-		(this->*exploreDirectionsDijkstraFlood[(currentNode->m_blockedDirectionBitfield * 8) + 
-			currentNode->m_directionFromParent])(currentNode);
+		(this->*exploreDirectionsDijkstraFlood[(m_blockedDirectionBitfield[currentNode] * 8) + 
+			m_directionFromParent[currentNode]])(currentNode);
 
-		currentNode->m_listStatus = PathfindingNode::OnClosed;
+		m_listStatus[currentNode] = PathfindingNode::OnClosed;
 	}
 }
 
-const void DijkstraFloodfill::Explore_AllDirectionsWithChecks(DijkstraPathfindingNode * currentNode)
+const void DijkstraFloodfill::Explore_AllDirectionsWithChecks(unsigned int currentNode)
 {
 	//DOWN, DOWNRIGHT, RIGHT, UPRIGHT, UP, UPLEFT, LEFT, DOWNLEFT
 	static const int offsetRow[] = { 1, 1, 0, -1, -1, -1,  0,  1 };
 	static const int offsetCol[] = { 0, 1, 1,  1,  0, -1, -1, -1 };
 
+	int currentRow = currentNode / m_width;
+	int currentCol = currentNode % m_width;
+
 	for (int i = 0; i < 8; ++i)
 	{
-		unsigned int neighborRow = currentNode->m_row + offsetRow[i];
+		int neighborRow = currentRow + offsetRow[i];
+		int neighborCol = currentCol + offsetCol[i];
 
-		// Out of grid bounds?
-		if (neighborRow >= m_height)
-			continue;
-
-		unsigned int neighborCol = currentNode->m_col + offsetCol[i];
-
-		// Out of grid bounds?
-		if (neighborCol >= m_width)
-			continue;
-
-		// Valid tile - get the node
-		DijkstraPathfindingNode* newSuccessor = &m_mapNodes[neighborRow][neighborCol];
-
-		// Blocked?
-		if (!m_map[neighborCol + (neighborRow * m_width)])
+		// Blocked? (the grid's wall border also covers neighbors outside the map)
+		if (m_grid->IsWall(neighborRow, neighborCol))
 			continue;
 
 		// Diagonal blocked?
 		bool isDiagonal = (i & 0x1) == 1;
-		if (isDiagonal && (!m_map[currentNode->m_col + ((currentNode->m_row + offsetRow[i]) * m_width)] ||
-			!m_map[currentNode->m_col + offsetCol[i] + (currentNode->m_row * m_width)]))
+		if (isDiagonal && (m_grid->IsWall(neighborRow, currentCol) ||
+			m_grid->IsWall(currentRow, neighborCol)))
 		{
 			continue;
 		}
 
-		unsigned int costToNextNode = isDiagonal ? FIXED_POINT_SQRT_2 : FIXED_POINT_ONE;
+		// Valid tile - get the node
+		unsigned int newSuccessor = neighborCol + (neighborRow * m_width);
+
+		PathCost costToNextNode = isDiagonal ? FIXED_POINT_SQRT_2 : FIXED_POINT_ONE;
 		ArrayDirections dir = (ArrayDirections)i;
 
 		PushNewNode(newSuccessor, currentNode, dir, dir, costToNextNode);
 	}
 }
 
-inline const void DijkstraFloodfill::Explore_Null(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_Null(unsigned int currentNode)
 {
 	// Purposely does nothing
 }
 
-inline const void DijkstraFloodfill::Explore_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_DR(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_DR(unsigned int currentNode)
 {
 	SearchDownRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_UR(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_UR(unsigned int currentNode)
 {
 	SearchUpRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_UL(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_UL(unsigned int currentNode)
 {
 	SearchUpLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_DL(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_DL(unsigned int currentNode)
 {
 	SearchDownLeft(currentNode);
 }
 
 // Adjacent Doubles
 
-inline const void DijkstraFloodfill::Explore_D_DR(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_DR(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchDownRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_DR_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_DR_R(unsigned int currentNode)
 {
 	SearchDownRight(currentNode);
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R_UR(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_UR(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchUpRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_UR_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_UR_U(unsigned int currentNode)
 {
 	SearchUpRight(currentNode);
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_UL(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_UL(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchUpLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_UL_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_UL_L(unsigned int currentNode)
 {
 	SearchUpLeft(currentNode);
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_DL(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_DL(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchDownLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_DL_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_DL_D(unsigned int currentNode)
 {
 	SearchDownLeft(currentNode);
 	SearchDown(currentNode);
@@ -297,37 +303,37 @@ inline const void DijkstraFloodfill::Explore_DL_D(DijkstraPathfindingNode * curr
 
 // Non-Adjacent Cardinal Doubles
 
-inline const void DijkstraFloodfill::Explore_D_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_R(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_U(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_L(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_D(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_D_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_U(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_L(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchLeft(currentNode);
@@ -335,56 +341,56 @@ inline const void DijkstraFloodfill::Explore_R_L(DijkstraPathfindingNode * curre
 
 // Adjacent Triples
 
-inline const void DijkstraFloodfill::Explore_D_DR_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_DR_R(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchDownRight(currentNode);
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_DR_R_UR(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_DR_R_UR(unsigned int currentNode)
 {
 	SearchDownRight(currentNode);
 	SearchRight(currentNode);
 	SearchUpRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R_UR_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_UR_U(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchUpRight(currentNode);
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_UR_U_UL(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_UR_U_UL(unsigned int currentNode)
 {
 	SearchUpRight(currentNode);
 	SearchUp(currentNode);
 	SearchUpLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_UL_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_UL_L(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchUpLeft(currentNode);
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_UL_L_DL(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_UL_L_DL(unsigned int currentNode)
 {
 	SearchUpLeft(currentNode);
 	SearchLeft(currentNode);
 	SearchDownLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_DL_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_DL_D(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchDownLeft(currentNode);
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_DL_D_DR(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_DL_D_DR(unsigned int currentNode)
 {
 	SearchDownLeft(currentNode);
 	SearchDown(currentNode);
@@ -393,28 +399,28 @@ inline const void DijkstraFloodfill::Explore_DL_D_DR(DijkstraPathfindingNode * c
 
 // Non-Adjacent Cardinal Triples
 
-inline const void DijkstraFloodfill::Explore_D_R_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_R_U(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchRight(currentNode);
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R_U_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_U_L(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchUp(currentNode);
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_L_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_L_D(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchLeft(currentNode);
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_D_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_D_R(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchDown(currentNode);
@@ -423,7 +429,7 @@ inline const void DijkstraFloodfill::Explore_L_D_R(DijkstraPathfindingNode * cur
 
 // Quads
 
-inline const void DijkstraFloodfill::Explore_R_DR_D_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_DR_D_L(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchDownRight(currentNode);
@@ -431,7 +437,7 @@ inline const void DijkstraFloodfill::Explore_R_DR_D_L(DijkstraPathfindingNode *
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_R_D_DL_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_D_DL_L(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchDown(currentNode);
@@ -439,7 +445,7 @@ inline const void DijkstraFloodfill::Explore_R_D_DL_L(DijkstraPathfindingNode *
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_UR_R_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_UR_R_D(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchUpRight(currentNode);
@@ -447,7 +453,7 @@ inline const void DijkstraFloodfill::Explore_U_UR_R_D(DijkstraPathfindingNode *
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_R_DR_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_R_DR_D(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchRight(currentNode);
@@ -455,7 +461,7 @@ inline const void DijkstraFloodfill::Explore_U_R_DR_D(DijkstraPathfindingNode *
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_UL_U_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_UL_U_R(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchUpLeft(currentNode);
@@ -463,7 +469,7 @@ inline const void DijkstraFloodfill::Explore_L_UL_U_R(DijkstraPathfindingNode *
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_U_UR_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_U_UR_R(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchUp(currentNode);
@@ -471,7 +477,7 @@ inline const void DijkstraFloodfill::Explore_L_U_UR_R(DijkstraPathfindingNode *
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_D_DL_L_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_DL_L_U(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchDownLeft(currentNode);
@@ -479,7 +485,7 @@ inline const void DijkstraFloodfill::Explore_D_DL_L_U(DijkstraPathfindingNode *
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_D_L_UL_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_L_UL_U(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchLeft(currentNode);
@@ -489,7 +495,7 @@ inline const void DijkstraFloodfill::Explore_D_L_UL_U(DijkstraPathfindingNode *
 
 // Quints
 
-inline const void DijkstraFloodfill::Explore_R_DR_D_DL_L(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_R_DR_D_DL_L(unsigned int currentNode)
 {
 	SearchRight(currentNode);
 	SearchDownRight(currentNode);
@@ -498,7 +504,7 @@ inline const void DijkstraFloodfill::Explore_R_DR_D_DL_L(DijkstraPathfindingNode
 	SearchLeft(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_U_UR_R_DR_D(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_U_UR_R_DR_D(unsigned int currentNode)
 {
 	SearchUp(currentNode);
 	SearchUpRight(currentNode);
@@ -507,7 +513,7 @@ inline const void DijkstraFloodfill::Explore_U_UR_R_DR_D(DijkstraPathfindingNode
 	SearchDown(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_L_UL_U_UR_R(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_L_UL_U_UR_R(unsigned int currentNode)
 {
 	SearchLeft(currentNode);
 	SearchUpLeft(currentNode);
@@ -516,7 +522,7 @@ inline const void DijkstraFloodfill::Explore_L_UL_U_UR_R(DijkstraPathfindingNode
 	SearchRight(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_D_DL_L_UL_U(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_D_DL_L_UL_U(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchDownLeft(currentNode);
@@ -525,7 +531,7 @@ inline const void DijkstraFloodfill::Explore_D_DL_L_UL_U(DijkstraPathfindingNode
 	SearchUp(currentNode);
 }
 
-inline const void DijkstraFloodfill::Explore_AllDirections(DijkstraPathfindingNode * currentNode)
+inline const void DijkstraFloodfill::Explore_AllDirections(unsigned int currentNode)
 {
 	SearchDown(currentNode);
 	SearchDownLeft(currentNode);
@@ -537,151 +543,112 @@ inline const void DijkstraFloodfill::Explore_AllDirections(DijkstraPathfindingNo
 	SearchDownRight(currentNode);
 }
 
-void DijkstraFloodfill::SearchDown(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchDown(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row + 1;
-	int newCol = currentNode->m_col;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_ONE;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, Down, givenCost);
+	unsigned int newSuccessor = currentNode + m_width;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_ONE;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], Down, givenCost);
 }
 
-void DijkstraFloodfill::SearchDownRight(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchDownRight(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row + 1;
-	int newCol = currentNode->m_col + 1;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SQRT_2;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, DownRight, givenCost);
+	unsigned int newSuccessor = currentNode + m_width + 1;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_SQRT_2;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], DownRight, givenCost);
 }
 
-void DijkstraFloodfill::SearchRight(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchRight(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row;
-	int newCol = currentNode->m_col + 1;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_ONE;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, Right, givenCost);
+	unsigned int newSuccessor = currentNode + 1;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_ONE;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], Right, givenCost);
 }
 
-void DijkstraFloodfill::SearchUpRight(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchUpRight(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row - 1;
-	int newCol = currentNode->m_col + 1;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SQRT_2;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, UpRight, givenCost);
+	unsigned int newSuccessor = currentNode - m_width + 1;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_SQRT_2;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], UpRight, givenCost);
 }
 
-void DijkstraFloodfill::SearchUp(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchUp(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row - 1;
-	int newCol = currentNode->m_col;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_ONE;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, Up, givenCost);
+	unsigned int newSuccessor = currentNode - m_width;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_ONE;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], Up, givenCost);
 }
 
-void DijkstraFloodfill::SearchUpLeft(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchUpLeft(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row - 1;
-	int newCol = currentNode->m_col - 1;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SQRT_2;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, UpLeft, givenCost);
+	unsigned int newSuccessor = currentNode - m_width - 1;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_SQRT_2;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], UpLeft, givenCost);
 }
 
-void DijkstraFloodfill::SearchLeft(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchLeft(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row;
-	int newCol = currentNode->m_col - 1;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_ONE;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, Left, givenCost);
+	unsigned int newSuccessor = currentNode - 1;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_ONE;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], Left, givenCost);
 }
 
-void DijkstraFloodfill::SearchDownLeft(DijkstraPathfindingNode * currentNode)
+void DijkstraFloodfill::SearchDownLeft(unsigned int currentNode)
 {
-	int newRow = currentNode->m_row + 1;
-	int newCol = currentNode->m_col - 1;
-	unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SQRT_2;
-	DijkstraPathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-	PushNewNode(newSuccessor, currentNode, (ArrayDirections)currentNode->m_directionFromStart, DownLeft, givenCost);
+	unsigned int newSuccessor = currentNode + m_width - 1;
+	PathCost givenCost = m_givenCost[currentNode] + FIXED_POINT_SQRT_2;
+	PushNewNode(newSuccessor, currentNode, (ArrayDirections)m_directionFromStart[currentNode], DownLeft, givenCost);
 }
 
 void DijkstraFloodfill::PushNewNode(
-	DijkstraPathfindingNode * newSuccessor, 
-	DijkstraPathfindingNode * currentNode, 
+	unsigned int newSuccessor, 
+	unsigned int currentNode, 
 	ArrayDirections startDirection, 
 	ArrayDirections parentDirection, 
-	unsigned int givenCost)
+	PathCost givenCost)
 {
-	if (newSuccessor->m_iteration != m_currentIteration)
+	if (m_iteration[newSuccessor] != (unsigned int)m_currentIteration)
 	{
 		// Place node on the Open list (we've never seen it before)
-		newSuccessor->m_parent = currentNode;
-		newSuccessor->m_directionFromStart = startDirection;
-		newSuccessor->m_directionFromParent = parentDirection;
-		newSuccessor->m_givenCost = givenCost;
-		newSuccessor->m_listStatus = PathfindingNode::OnOpen;
-		newSuccessor->m_iteration = m_currentIteration;
+		m_directionFromStart[newSuccessor] = startDirection;
+		m_directionFromParent[newSuccessor] = parentDirection;
+		m_givenCost[newSuccessor] = givenCost;
+		m_listStatus[newSuccessor] = PathfindingNode::OnOpen;
+		m_iteration[newSuccessor] = m_currentIteration;
 
 #ifdef USE_FAST_OPEN_LIST
-		m_fastOpenList->Push(newSuccessor);
+		m_fastOpenList->Push(newSuccessor, givenCost);
 #else
-		m_openList.add(newSuccessor);
+		m_openList->Push(newSuccessor, givenCost);
 #endif
 	}
-	else if (givenCost < newSuccessor->m_givenCost &&
-		newSuccessor->m_listStatus == PathfindingNode::OnOpen)
+	else if (givenCost < m_givenCost[newSuccessor] &&
+		m_listStatus[newSuccessor] == PathfindingNode::OnOpen)
 	{
 		// We found a cheaper way to this node - update it
-		unsigned int lastCost = newSuccessor->m_givenCost;
-		newSuccessor->m_parent = currentNode;
-		newSuccessor->m_directionFromStart = startDirection;
-		newSuccessor->m_directionFromParent = parentDirection;
-		newSuccessor->m_givenCost = givenCost;
+		PathCost lastCost = m_givenCost[newSuccessor];
+		m_directionFromStart[newSuccessor] = startDirection;
+		m_directionFromParent[newSuccessor] = parentDirection;
+		m_givenCost[newSuccessor] = givenCost;
 
 #ifdef USE_FAST_OPEN_LIST
-		m_fastOpenList->DecreaseKey(newSuccessor, lastCost);
+		m_fastOpenList->DecreaseKey(newSuccessor, lastCost, givenCost);
 #else
-		m_openList.decreaseKey(newSuccessor);
+		m_openList->DecreaseKey(newSuccessor, givenCost);
 #endif
 	}
 }
 
-inline bool DijkstraFloodfill::IsEmpty(int r, int c)
-{
-	unsigned int colBoundsCheck = c;
-	unsigned int rowBoundsCheck = r;
-	if (colBoundsCheck < (unsigned int)m_width && rowBoundsCheck < (unsigned int)m_height)
-	{
-		return m_map[c + (r * m_width)];
-	}
-	else
-	{
-		return false;
-	}
-}
-
 template <typename T>
-void DijkstraFloodfill::InitArray(T**& t, int width, int height)
+void DijkstraFloodfill::InitArray(T*& t, int size)
 {
-	t = new T*[height];
-	for (int i = 0; i < height; ++i)
-	{
-		t[i] = new T[width];
-		memset(t[i], 0, sizeof(T)*width);
-	}
+	t = (T*)_aligned_malloc(sizeof(T)*size, 64);
+	memset(t, 0, sizeof(T)*size);
 }
 
 template <typename T>
-void DijkstraFloodfill::DestroyArray(T**& t)
+void DijkstraFloodfill::DestroyArray(T*& t)
 {
-	for (int i = 0; i < m_height; ++i)
-		delete[] t[i];
-	delete[] t;
-
+	_aligned_free(t);
 	t = 0;
 }
 
@@ -40,14 +40,11 @@
 #pragma once
 #include <vector>
 #include "PathfindingNode.h"
-#include "GenericHeap.h"
+#include "IndexedHeap.h"
 #include "BucketPriorityQueue.h"
 #include "PrecomputeMap.h"
 
-#define MAX_WIDTH 2048
-#define MAX_HEIGHT 2048
-
-#define USE_FAST_OPEN_LIST	// Significantly faster, but preallocated memory might not be large enough. Verify in cpp file.
+#define USE_FAST_OPEN_LIST	// Significantly faster (circular bucket queue instead of a binary heap)
 
 // A Dijkstra floodfill has no goal. It floods the map from the starting node until all connected nodes are exhausted.
 // This Dijkstra floodfill propagate to all explored nodes the original direction it left the staring node. This is
@@ -56,126 +53,112 @@
 class DijkstraFloodfill
 {
 public:
-	DijkstraFloodfill(int width, int height, std::vector<bool> map, DistantJumpPoints** distantJumpPointMap);
+	DijkstraFloodfill(const BitGrid* grid, DistantJumpPoints* distantJumpPointMap);
 	~DijkstraFloodfill();
 
 	void Flood(int r, int c);
 	inline int GetCurrentInteration() { return m_currentIteration; }
 
-	DijkstraPathfindingNode ** m_mapNodes;
+	// Results of the last flood, by cell index (row * width + col)
+	inline bool IsClosed(unsigned int node) { return m_iteration[node] == (unsigned int)m_currentIteration && m_listStatus[node] == PathfindingNode::OnClosed; }
+	inline unsigned char GetDirectionFromStart(unsigned int node) { return m_directionFromStart[node]; }
 
 private:
 
 	// 48 function variations of exploring (used in 2048 entry look-up table)
 	// D = Down, U = Up, R = Right, L = Left, DR = Down Right, DL = Down Left, UR = Up Right, UL = Up Left
-	const void Explore_Null(DijkstraPathfindingNode * currentNode);
-	const void Explore_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_DR(DijkstraPathfindingNode * currentNode);
-	const void Explore_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_UR(DijkstraPathfindingNode * currentNode);
-	const void Explore_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_UL(DijkstraPathfindingNode * currentNode);
-	const void Explore_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_DL(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_DR(DijkstraPathfindingNode * currentNode);
-	const void Explore_DR_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_UR(DijkstraPathfindingNode * currentNode);
-	const void Explore_UR_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_UL(DijkstraPathfindingNode * currentNode);
-	const void Explore_UL_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_DL(DijkstraPathfindingNode * currentNode);
-	const void Explore_DL_D(DijkstraPathfindingNode * currentNod);
-	const void Explore_D_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_DR_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_DR_R_UR(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_UR_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_UR_U_UL(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_UL_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_UL_L_DL(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_DL_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_DL_D_DR(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_R_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_U_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_L_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_D_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_DR_D_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_D_DL_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_UR_R_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_R_DR_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_UL_U_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_U_UR_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_DL_L_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_L_UL_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_R_DR_D_DL_L(DijkstraPathfindingNode * currentNode);
-	const void Explore_U_UR_R_DR_D(DijkstraPathfindingNode * currentNode);
-	const void Explore_L_UL_U_UR_R(DijkstraPathfindingNode * currentNode);
-	const void Explore_D_DL_L_UL_U(DijkstraPathfindingNode * currentNode);
-	const void Explore_AllDirections(DijkstraPathfindingNode * currentNode);
-
-	const void Explore_AllDirectionsWithChecks(DijkstraPathfindingNode * currentNode);
-
-	void SearchDown(DijkstraPathfindingNode * currentNode);
-	void SearchDownRight(DijkstraPathfindingNode * currentNode);
-	void SearchRight(DijkstraPathfindingNode * currentNode);
-	void SearchUpRight(DijkstraPathfindingNode * currentNode);
-	void SearchUp(DijkstraPathfindingNode * currentNode);
-	void SearchUpLeft(DijkstraPathfindingNode * currentNode);
-	void SearchLeft(DijkstraPathfindingNode * currentNode);
-	void SearchDownLeft(DijkstraPathfindingNode * currentNode);
+	const void Explore_Null(unsigned int currentNode);
+	const void Explore_D(unsigned int currentNode);
+	const void Explore_DR(unsigned int currentNode);
+	const void Explore_R(unsigned int currentNode);
+	const void Explore_UR(unsigned int currentNode);
+	const void Explore_U(unsigned int currentNode);
+	const void Explore_UL(unsigned int currentNode);
+	const void Explore_L(unsigned int currentNode);
+	const void Explore_DL(unsigned int currentNode);
+	const void Explore_D_DR(unsigned int currentNode);
+	const void Explore_DR_R(unsigned int currentNode);
+	const void Explore_R_UR(unsigned int currentNode);
+	const void Explore_UR_U(unsigned int currentNode);
+	const void Explore_U_UL(unsigned int currentNode);
+	const void Explore_UL_L(unsigned int currentNode);
+	const void Explore_L_DL(unsigned int currentNode);
+	const void Explore_DL_D(unsigned int currentNode);
+	const void Explore_D_R(unsigned int currentNode);
+	const void Explore_R_U(unsigned int currentNode);
+	const void Explore_U_L(unsigned int currentNode);
+	const void Explore_L_D(unsigned int currentNode);
+	const void Explore_D_U(unsigned int currentNode);
+	const void Explore_R_L(unsigned int currentNode);
+	const void Explore_D_DR_R(unsigned int currentNode);
+	const void Explore_DR_R_UR(unsigned int currentNode);
+	const void Explore_R_UR_U(unsigned int currentNode);
+	const void Explore_UR_U_UL(unsigned int currentNode);
+	const void Explore_U_UL_L(unsigned int currentNode);
+	const void Explore_UL_L_DL(unsigned int currentNode);
+	const void Explore_L_DL_D(unsigned int currentNode);
+	const void Explore_DL_D_DR(unsigned int currentNode);
+	const void Explore_D_R_U(unsigned int currentNode);
+	const void Explore_R_U_L(unsigned int currentNode);
+	const void Explore_U_L_D(unsigned int currentNode);
+	const void Explore_L_D_R(unsigned int currentNode);
+	const void Explore_R_DR_D_L(unsigned int currentNode);
+	const void Explore_R_D_DL_L(unsigned int currentNode);
+	const void Explore_U_UR_R_D(unsigned int currentNode);
+	const void Explore_U_R_DR_D(unsigned int currentNode);
+	const void Explore_L_UL_U_R(unsigned int currentNode);
+	const void Explore_L_U_UR_R(unsigned int currentNode);
+	const void Explore_D_DL_L_U(unsigned int currentNode);
+	const void Explore_D_L_UL_U(unsigned int currentNode);
+	const void Explore_R_DR_D_DL_L(unsigned int currentNode);
+	const void Explore_U_UR_R_DR_D(unsigned int currentNode);
+	const void Explore_L_UL_U_UR_R(unsigned int currentNode);
+	const void Explore_D_DL_L_UL_U(unsigned int currentNode);
+	const void Explore_AllDirections(unsigned int currentNode);
+
+	const void Explore_AllDirectionsWithChecks(unsigned int currentNode);
+
+	void SearchDown(unsigned int currentNode);
+	void SearchDownRight(unsigned int currentNode);
+	void SearchRight(unsigned int currentNode);
+	void SearchUpRight(unsigned int currentNode);
+	void SearchUp(unsigned int currentNode);
+	void SearchUpLeft(unsigned int currentNode);
+	void SearchLeft(unsigned int currentNode);
+	void SearchDownLeft(unsigned int currentNode);
 
 	void PushNewNode(
-		DijkstraPathfindingNode * newSuccessor, 
-		DijkstraPathfindingNode * currentNode, 
+		unsigned int newSuccessor, 
+		unsigned int currentNode, 
 		ArrayDirections startDirection, 
 		ArrayDirections parentDirection, 
-		unsigned int givenCost);
-
-	// Helper functions for heap open list
-	struct PathfindingNodeEqual {
-		bool operator()(const DijkstraPathfindingNode* i1, const DijkstraPathfindingNode* i2)
-		{
-			return (i1 == i2);
-		}
-	};
-
-	struct PathfindingNodeCmp : std::binary_function<bool, DijkstraPathfindingNode* const, DijkstraPathfindingNode* const> {
-		bool operator()(DijkstraPathfindingNode* const lhs, DijkstraPathfindingNode* const rhs) const {
-			return lhs->m_givenCost > rhs->m_givenCost;
-		}
-	};
-
-	struct SearchNodeHash {
-		size_t operator()(const DijkstraPathfindingNode* x) const
-		{
-			return (size_t)(x->m_col + (x->m_row * MAX_WIDTH));
-		}
-	};
-
-	typedef GenericHeap<DijkstraPathfindingNode*, SearchNodeHash,
-		PathfindingNodeEqual, PathfindingNodeCmp> PQueue;
+		PathCost givenCost);
 
 	// Open list
-	PQueue m_openList;
 #ifdef USE_FAST_OPEN_LIST
 	BucketPriorityQueue* m_fastOpenList;
+#else
+	IndexedHeap* m_openList;
 #endif
 
 	// Map properties
 	int m_width, m_height;
-	std::vector<bool> m_map;
+	const BitGrid* m_grid;
+
+	// Node storage, structure of arrays indexed by cell (row * width + col).
+	// Only what the flood needs is kept: no parent pointers and no coordinates.
+	PathCost* m_givenCost;
+	unsigned int* m_iteration;
+	unsigned int* m_openListIndex;
+	unsigned char* m_directionFromStart;
+	unsigned char* m_directionFromParent;
+	unsigned char* m_blockedDirectionBitfield;	// highest bit [DownLeft, Left, UpLeft, Up, UpRight, Right, DownRight, Down] lowest bit
+	unsigned char* m_listStatus;
 
 	// Search specific info
 	int m_currentIteration;	// This allows us to know if a node has been touched this iteration (faster than clearing all the nodes before each search)
 
-	// Wall queries
-	bool IsEmpty(int r, int c);
-
-	// 2D array initialization and destruction
-	template <typename T> void InitArray(T**& t, int width, int height);
-	template <typename T> void DestroyArray(T**& t);
+	// Node array initialization and destruction
+	template <typename T> void InitArray(T*& t, int size);
+	template <typename T> void DestroyArray(T*& t);
 };
@@ -52,23 +52,39 @@ void PreprocessMap(std::vector<bool> &bits, int w, int h, const char *filename)
 {
 	printf("Writing to file '%s'\n", filename);
 
-	PrecomputeMap precomputeMap(w, h, bits);
-	precomputeMap.CalculateMap();
-	precomputeMap.SaveMap(filename);
+	BitGrid grid(bits, w, h);
+	PrecomputeMap precomputeMap(&grid);
+	precomputeMap.CalculateMap(filename);
+}
+
+void PreprocessMapIncremental(std::vector<bool> &oldBits, std::vector<bool> &bits, int w, int h, const char *oldFilename, const char *filename)
+{
+	printf("Updating '%s' into '%s'\n", oldFilename, filename);
+
+	BitGrid oldGrid(oldBits, w, h);
+	BitGrid grid(bits, w, h);
+	PrecomputeMap precomputeMap(&grid);
+	precomputeMap.CalculateMapIncremental(&oldGrid, oldFilename, filename);
 }
 
 void *PrepareForSearch(std::vector<bool> &bits, int w, int h, const char *filename)
 {
 	//printf("Reading from file '%s'\n", filename);
 
-	PrecomputeMap precomputeMap(w, h, bits);
+	// The grid is packed once and handed over to the search, which owns it
+	BitGrid* grid = new BitGrid(bits, w, h);
+	PrecomputeMap precomputeMap(grid);
 	precomputeMap.LoadMap(filename);
-	JumpDistancesAndGoalBounds** preprocessedMap = precomputeMap.GetPreprocessedMap();
-	return (void*)new JPSPlus(preprocessedMap, bits, w, h);
+	return (void*)CreateJPSPlus(precomputeMap.GetJumpDistancesMap(), precomputeMap.GetGoalBoundsMap(), precomputeMap.GetGoalBoxes(), precomputeMap.GetNodeDataOffsets(), grid);
 }
 
 bool GetPath(void *data, xyLoc s, xyLoc g, std::vector<xyLoc> &path)
 {
-	JPSPlus* search = (JPSPlus*)data;
+	JPSPlusSearch* search = (JPSPlusSearch*)data;
 	return search->GetPath((xyLocJPS&)s, (xyLocJPS&)g, (std::vector<xyLocJPS>&)path);
 }
+
+void ReleaseSearch(void *data)
+{
+	delete (JPSPlusSearch*)data;
+}
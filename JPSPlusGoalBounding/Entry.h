@@ -38,13 +38,18 @@
  */ 
 
 #include <stdint.h>
+#include "MapTypes.h"
 
 struct xyLoc {
-  int16_t x;
-  int16_t y;
+  MapCoordinate x;
+  MapCoordinate y;
 };
 
 void PreprocessMap(std::vector<bool> &bits, int width, int height, const char *filename);
+// Rebuilds a .pre after cells of a map of the same size changed (oldFilename must differ from filename)
+void PreprocessMapIncremental(std::vector<bool> &oldBits, std::vector<bool> &bits, int width, int height, const char *oldFilename, const char *filename);
 void *PrepareForSearch(std::vector<bool> &bits, int width, int height, const char *filename);
 bool GetPath(void *data, xyLoc s, xyLoc g, std::vector<xyLoc> &path);
+// Frees what PrepareForSearch returned
+void ReleaseSearch(void *data);
 const char *GetName();
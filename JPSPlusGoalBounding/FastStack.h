@@ -48,16 +48,30 @@
 class FastStack
 {
 public:
-	FastStack(int size) : m_nextFreeNode(0) { m_nodeArray = new PathfindingNode*[size]; }
+	FastStack(int size) : m_nextFreeNode(0), m_size(size) { m_nodeArray = new PathfindingNode*[size]; }
 	~FastStack(void) { delete[] m_nodeArray; }
 
 	inline void Reset(void) { m_nextFreeNode = 0; }
 	inline bool Empty(void) { return m_nextFreeNode == 0; }
-	inline void Push(PathfindingNode* node) { m_nodeArray[m_nextFreeNode++] = node; }
+	inline void Push(PathfindingNode* node)
+	{
+		if (m_nextFreeNode == m_size) { Grow(); }
+		m_nodeArray[m_nextFreeNode++] = node;
+	}
 	PathfindingNode* Pop(void) { return m_nodeArray[--m_nextFreeNode]; }
 
 private:
 	int m_nextFreeNode;
+	int m_size;
 	PathfindingNode** m_nodeArray;
+
+	void Grow()
+	{
+		PathfindingNode** nodeArray = new PathfindingNode*[m_size * 2];
+		memcpy(nodeArray, m_nodeArray, sizeof(PathfindingNode*) * m_nextFreeNode);
+		delete[] m_nodeArray;
+		m_nodeArray = nodeArray;
+		m_size *= 2;
+	}
 };
 
@@ -0,0 +1,161 @@
+/*
+ * IndexedHeap.cpp
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include "stdafx.h"
+#include "IndexedHeap.h"
+
+#define HEAP_ARITY 4
+
+IndexedHeap::IndexedHeap(int arraySize, unsigned int* openListIndex)
+: m_nextFreeNode(0), m_arraySize(arraySize), m_openListIndex(openListIndex)
+{
+	m_nodeArray = new unsigned int[arraySize];
+	m_costArray = new PathCost[arraySize];
+}
+
+IndexedHeap::~IndexedHeap()
+{
+	delete[] m_nodeArray;
+	delete[] m_costArray;
+}
+
+void IndexedHeap::Push(unsigned int node, PathCost cost)
+{
+	if (m_nextFreeNode == m_arraySize)
+	{
+		Grow();
+	}
+
+	SiftUp(m_nextFreeNode++, node, cost);
+}
+
+unsigned int IndexedHeap::Pop(void)
+{
+	unsigned int cheapestNode = m_nodeArray[0];
+
+	// Move the last node to the root and let it sink
+	--m_nextFreeNode;
+	if (m_nextFreeNode > 0)
+	{
+		SiftDown(0, m_nodeArray[m_nextFreeNode], m_costArray[m_nextFreeNode]);
+	}
+
+	return cheapestNode;
+}
+
+void IndexedHeap::DecreaseKey(unsigned int node, PathCost cost)
+{
+	SiftUp(m_openListIndex[node], node, cost);
+}
+
+// Moves the hole at index up until the node fits, then places the node there
+void IndexedHeap::SiftUp(int index, unsigned int node, PathCost cost)
+{
+	while (index > 0)
+	{
+		int parent = (index - 1) / HEAP_ARITY;
+		if (m_costArray[parent] <= cost)
+		{
+			break;
+		}
+
+		m_nodeArray[index] = m_nodeArray[parent];
+		m_costArray[index] = m_costArray[parent];
+		m_openListIndex[m_nodeArray[index]] = index;
+		index = parent;
+	}
+
+	m_nodeArray[index] = node;
+	m_costArray[index] = cost;
+	m_openListIndex[node] = index;
+}
+
+// Moves the hole at index down until the node fits, then places the node there
+void IndexedHeap::SiftDown(int index, unsigned int node, PathCost cost)
+{
+	while (true)
+	{
+		int firstChild = (index * HEAP_ARITY) + 1;
+		if (firstChild >= m_nextFreeNode)
+		{
+			break;
+		}
+
+		// Find the cheapest child
+		int lastChild = firstChild + HEAP_ARITY;
+		if (lastChild > m_nextFreeNode) { lastChild = m_nextFreeNode; }
+
+		int cheapestChild = firstChild;
+		for (int child = firstChild + 1; child < lastChild; ++child)
+		{
+			if (m_costArray[child] < m_costArray[cheapestChild])
+			{
+				cheapestChild = child;
+			}
+		}
+
+		if (cost <= m_costArray[cheapestChild])
+		{
+			break;
+		}
+
+		m_nodeArray[index] = m_nodeArray[cheapestChild];
+		m_costArray[index] = m_costArray[cheapestChild];
+		m_openListIndex[m_nodeArray[index]] = index;
+		index = cheapestChild;
+	}
+
+	m_nodeArray[index] = node;
+	m_costArray[index] = cost;
+	m_openListIndex[node] = index;
+}
+
+void IndexedHeap::Grow()
+{
+	unsigned int* nodeArray = new unsigned int[m_arraySize * 2];
+	PathCost* costArray = new PathCost[m_arraySize * 2];
+	memcpy(nodeArray, m_nodeArray, sizeof(unsigned int) * m_nextFreeNode);
+	memcpy(costArray, m_costArray, sizeof(PathCost) * m_nextFreeNode);
+	delete[] m_nodeArray;
+	delete[] m_costArray;
+
+	m_nodeArray = nodeArray;
+	m_costArray = costArray;
+	m_arraySize *= 2;
+}
@@ -39,6 +39,8 @@
 
 #include "stdafx.h"
 #include "JPSPlus.h"
+#include "LargePageArray.h"
+#include <malloc.h>
 
 // Ideal choice of fixed-point equivalent to 1.0 that can almost perfectly represent sqrt(2) and (sqrt(2) - 1) in whole numbers
 // 1.000000000 = 2378
@@ -51,66 +53,108 @@
 #define SQRT_2 3363
 #define SQRT_2_MINUS_ONE 985
 
-typedef const void (JPSPlus::*FunctionPointer)(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
+// Searches per sweep of the stale node reset, half the 65535 stamps (see NextIteration)
+static const unsigned int StaleNodeResetSearches = 32768;
 
-JPSPlus::JPSPlus(JumpDistancesAndGoalBounds** jumpDistancesAndGoalBoundsMap, std::vector<bool> &rawMap, int w, int h)
+template <int StrideShift>
+JPSPlus<StrideShift>::JPSPlus(NodeJumpDistances* jumpDistancesMap, NodeGoalBounds* goalBoundsMap, GoalBox* goalBoxes, unsigned int* nodeDataOffsets, const BitGrid* grid)
 {
 	// Map properties
-	m_width = w;
-	m_height = h;
+	m_grid = grid;
+	m_width = grid->GetWidth();
+	m_height = grid->GetHeight();
+	m_cellStride = GetCellStride(m_width);
 
-	// Adjust preallocation for worst-case
+	// Preallocation for the common case, both grow as needed
 	m_simpleUnsortedPriorityQueue = new SimpleUnsortedPriorityQueue(10000);
 	m_fastStack = new FastStack(1000);
 
-	m_jumpDistancesAndGoalBounds = jumpDistancesAndGoalBoundsMap;
+	m_jumpDistances = jumpDistancesMap;
+	m_goalBounds = goalBoundsMap;
+	m_goalBoxes = goalBoxes;
 	m_currentIteration = 1;	// This gets incremented on each search
+#ifdef DENSE_NODE_DATA
+	m_nodeDataOffsets = nodeDataOffsets;
 
+	// A record holds the goal bounds of its open directions only, in direction order
+	for (int blocked = 0; blocked < 256; blocked++)
+	{
+		int slot = 0;
+		for (int dir = 0; dir < 8; dir++)
+		{
+			m_goalBoundsSlot[blocked][dir] = (unsigned char)slot;
+			if ((blocked & (1 << dir)) == 0)
+			{
+				slot++;
+			}
+		}
+	}
+#endif
+#ifdef QUANTIZED_GOAL_BOUNDS
+	m_tileShift = GetGoalBoundsTileShift(m_width, m_height);
+#endif
+
+#ifdef SPARSE_SEARCH_NODES
+	// Nodes are added as the searches touch cells
+	m_sparseNodes = new SparseNodeTable(4096);
+#else
 	// Initialize nodes
-	InitArray(m_mapNodes, m_width, m_height);
+	InitArray(m_mapNodes, GetCellLayoutWidth(GetStride()), GetCellLayoutHeight(m_height));
+	m_numNodes = GetCellLayoutWidth(GetStride()) * GetCellLayoutHeight(m_height);
+	m_staleNodeCursor = 0;
+	m_staleNodesPerSearch = (m_numNodes + StaleNodeResetSearches - 1) / StaleNodeResetSearches;
 	for (int r = 0; r<m_height; r++)
 	{
 		for (int c = 0; c<m_width; c++)
 		{
-			PathfindingNode& node = m_mapNodes[r][c];
-			node.m_row = r;
-			node.m_col = c;
+			PathfindingNode& node = m_mapNodes[GetCellIndex(r, c, GetStride())];
 			node.m_listStatus = PathfindingNode::OnNone;
 			node.m_iteration = 0;
 		}
 	}
+#endif
 }
 
-JPSPlus::~JPSPlus()
+template <int StrideShift>
+JPSPlus<StrideShift>::~JPSPlus()
 {
 	delete m_fastStack;
 	delete m_simpleUnsortedPriorityQueue;
-	DestroyArray(m_jumpDistancesAndGoalBounds);
+	DestroyArray(m_jumpDistances);
+#ifdef SPLIT_HOT_COLD_NODE_DATA
+	DestroyArray(m_goalBounds);
+#endif
+#ifdef DENSE_NODE_DATA
+	DestroyArray(m_nodeDataOffsets);
+#endif
+	delete[] m_goalBoxes;
+#ifdef SPARSE_SEARCH_NODES
+	delete m_sparseNodes;
+#else
 	DestroyArray(m_mapNodes);
+#endif
+	delete m_grid;
 }
 
+template <int StrideShift>
 template <typename T>
-void JPSPlus::InitArray(T**& t, int width, int height)
+void JPSPlus<StrideShift>::InitArray(T*& t, int width, int height)
 {
-	t = new T*[height];
-	for (int i = 0; i < height; ++i)
-	{
-		t[i] = new T[width];
-		memset(t[i], 0, sizeof(T)*width);
-	}
+	// One cache line aligned block per map, indexed by cell (see GetCellIndex)
+	t = (T*)AllocateArrayMemory(sizeof(T)*width*height);
+	memset(t, 0, sizeof(T)*width*height);
 }
 
+template <int StrideShift>
 template <typename T>
-void JPSPlus::DestroyArray(T**& t)
+void JPSPlus<StrideShift>::DestroyArray(T*& t)
 {
-	for (int i = 0; i < m_height; ++i)
-		delete[] t[i];
-	delete[] t;
-
+	FreeArrayMemory(t);
 	t = 0;
 }
 
-bool JPSPlus::GetPath(xyLocJPS& s, xyLocJPS& g, std::vector<xyLocJPS> &path)
+template <int StrideShift>
+bool JPSPlus<StrideShift>::GetPath(xyLocJPS& s, xyLocJPS& g, std::vector<xyLocJPS> &path)
 {
 	if (path.size() > 0)
 	{
@@ -122,21 +166,28 @@ bool JPSPlus::GetPath(xyLocJPS& s, xyLocJPS& g, std::vector<xyLocJPS> &path)
 	int startCol = s.x;
 	m_goalRow = g.y;
 	m_goalCol = g.x;
+#ifdef QUANTIZED_GOAL_BOUNDS
+	m_goalRowTile = m_goalRow >> m_tileShift;
+	m_goalColTile = m_goalCol >> m_tileShift;
+#endif
 
 	{
 		// Initialize map
 		path.clear();
 
-		m_goalNode = &m_mapNodes[m_goalRow][m_goalCol];
-		m_currentIteration++;
+#ifdef SPARSE_SEARCH_NODES
+		m_sparseNodes->Reset();
+#endif
+		m_goalNode = GetNode(GetCellIndex(m_goalRow, m_goalCol, GetStride()));
+		NextIteration();
 
 		m_fastStack->Reset();
 		m_simpleUnsortedPriorityQueue->Reset();
 	}
 
 	// Create starting node
-	PathfindingNode* startNode = &m_mapNodes[startRow][startCol];
-	startNode->m_parent = NULL;
+	PathfindingNode* startNode = GetNode(GetCellIndex(startRow, startCol, GetStride()));
+	startNode->m_parent = PathfindingNode::NoParent;
 	startNode->m_givenCost = 0;
 	startNode->m_finalCost = 0;
 	startNode->m_listStatus = PathfindingNode::OnOpen;
@@ -162,7 +213,34 @@ bool JPSPlus::GetPath(xyLocJPS& s, xyLocJPS& g, std::vector<xyLocJPS> &path)
 	}
 }
 
-PathStatus JPSPlus::SearchLoop(PathfindingNode* startNode)
+template <int StrideShift>
+void JPSPlus<StrideShift>::NextIteration()
+{
+	// The stamp wraps every 65535 searches (0 is skipped, it marks untouched nodes), after which
+	// a node last touched that many searches ago would look touched. So every search also resets
+	// a slice of the nodes to 0, sized so the slices sweep the whole array twice per wrap. A node
+	// is reset before its stamp comes around again and no search pays for a full clear.
+	if (++m_currentIteration == 0)
+	{
+		m_currentIteration = 1;
+	}
+
+#ifndef SPARSE_SEARCH_NODES
+	unsigned int end = m_staleNodeCursor + m_staleNodesPerSearch;
+	if (end > m_numNodes)
+	{
+		end = m_numNodes;
+	}
+	for (unsigned int i = m_staleNodeCursor; i < end; i++)
+	{
+		m_mapNodes[i].m_iteration = 0;
+	}
+	m_staleNodeCursor = end < m_numNodes ? end : 0;
+#endif
+}
+
+template <int StrideShift>
+PathStatus JPSPlus<StrideShift>::SearchLoop(PathfindingNode* startNode)
 {
 	// Create 2048 entry function pointer lookup table
 	#define CASE(x) &JPSPlus::Explore_ ## x ## ,
@@ -180,8 +258,11 @@ PathStatus JPSPlus::SearchLoop(PathfindingNode* startNode)
 			return PathFound;
 		}
 
-		JumpDistancesAndGoalBounds* jumpDistancesAndGoalBounds = &m_jumpDistancesAndGoalBounds[startNode->m_row][startNode->m_col];
-		Explore_AllDirections(startNode, jumpDistancesAndGoalBounds);
+		unsigned int index = SetCurrentNode(startNode);
+#ifdef COMPRESSED_GOAL_BOUNDS
+		SetGoalOffsets(startNode);
+#endif
+		Explore_AllDirections(startNode, GetJumpDistances(index), GetGoalBounds(index));
 		startNode->m_listStatus = PathfindingNode::OnClosed;
 	}
 
@@ -196,6 +277,10 @@ PathStatus JPSPlus::SearchLoop(PathfindingNode* startNode)
 		else
 		{
 			currentNode = m_simpleUnsortedPriorityQueue->Pop();
+			if (currentNode == 0)
+			{
+				break;	// Only dropped entries were left
+			}
 		}
 
 		if (currentNode == m_goalNode)
@@ -204,18 +289,22 @@ PathStatus JPSPlus::SearchLoop(PathfindingNode* startNode)
 		}
 		
 		// Explore nodes based on parent
-		JumpDistancesAndGoalBounds* jumpDistancesAndGoalBounds = 
-			&m_jumpDistancesAndGoalBounds[currentNode->m_row][currentNode->m_col];
+		unsigned int index = SetCurrentNode(currentNode);
+		NodeJumpDistances* jumpDistances = GetJumpDistances(index);
+#ifdef COMPRESSED_GOAL_BOUNDS
+		SetGoalOffsets(currentNode);
+#endif
 
-		(this->*exploreDirections[(jumpDistancesAndGoalBounds->blockedDirectionBitfield * 8) + 
-			currentNode->m_directionFromParent])(currentNode, jumpDistancesAndGoalBounds);
+		(this->*exploreDirections[(jumpDistances->blockedDirectionBitfield * 8) + 
+			currentNode->m_directionFromParent])(currentNode, jumpDistances, GetGoalBounds(index));
 
 		currentNode->m_listStatus = PathfindingNode::OnClosed;
 	}
 	return NoPathExists;
 }
 
-void JPSPlus::FinalizePath(std::vector<xyLocJPS> &finalPath)
+template <int StrideShift>
+void JPSPlus<StrideShift>::FinalizePath(std::vector<xyLocJPS> &finalPath)
 {
 	PathfindingNode* prevNode = NULL;
 	PathfindingNode* curNode = m_goalNode;
@@ -223,14 +312,14 @@ void JPSPlus::FinalizePath(std::vector<xyLocJPS> &finalPath)
 	while (curNode != NULL)
 	{
 		xyLocJPS loc;
-		loc.x = curNode->m_col;
-		loc.y = curNode->m_row;
+		loc.x = GetCol(curNode);
+		loc.y = GetRow(curNode);
 
 		if (prevNode != NULL)
 		{
 			// Insert extra nodes if needed (may not be neccessary depending on final path use)
-			int xDiff = curNode->m_col - prevNode->m_col;
-			int yDiff = curNode->m_row - prevNode->m_row;
+			int xDiff = GetCol(curNode) - GetCol(prevNode);
+			int yDiff = GetRow(curNode) - GetRow(prevNode);
 
 			int xInc = 0;
 			int yInc = 0;
@@ -241,8 +330,8 @@ void JPSPlus::FinalizePath(std::vector<xyLocJPS> &finalPath)
 			if (yDiff > 0) { yInc = 1; }
 			else if (yDiff < 0) { yInc = -1; yDiff = -yDiff; }
 
-			int x = prevNode->m_col;
-			int y = prevNode->m_row;
+			int x = GetCol(prevNode);
+			int y = GetRow(prevNode);
 			int steps = xDiff - 1;
 			if (yDiff > xDiff) { steps = yDiff - 1; }
 
@@ -261,150 +350,209 @@ void JPSPlus::FinalizePath(std::vector<xyLocJPS> &finalPath)
 
 		finalPath.push_back(loc);
 		prevNode = curNode;
-		curNode = curNode->m_parent;
+		curNode = (curNode->m_parent == PathfindingNode::NoParent) ? NULL : GetNode(curNode->m_parent);
 	}
 	std::reverse(finalPath.begin(), finalPath.end());
 }
 
+#ifdef DENSE_NODE_DATA
+// Only the open directions have goal bounds in a dense record
+#define MacroGoalBoundsSlot(dir) m_goalBoundsSlot[map->blockedDirectionBitfield][dir]
+#else
+#define MacroGoalBoundsSlot(dir) dir
+#endif
+
+#ifdef COMPRESSED_GOAL_BOUNDS
+// Goal bounds are offsets from the current node, confirmed in the side table when both are saturated
+#define MacroGoalRow m_goalRowOffset
+#define MacroGoalCol m_goalColOffset
+#define MacroGoalBox(dir) goalBounds->bounds[MacroGoalBoundsSlot(dir)]
+#define MacroInsideFarGoalBounds(dir) \
+	(!m_goalIsFar || (goalBounds->farBoundsBitfield & (1 << dir)) == 0 || \
+		IsInsideFarGoalBounds(goalBounds, dir))
+#elif defined(QUANTIZED_GOAL_BOUNDS)
+// Goal bounds are in tiles, against the goal's tile
+#define MacroGoalRow m_goalRowTile
+#define MacroGoalCol m_goalColTile
+#define MacroGoalBox(dir) goalBounds->bounds[MacroGoalBoundsSlot(dir)]
+#define MacroInsideFarGoalBounds(dir) true
+#elif defined(DICTIONARY_GOAL_BOUNDS)
+// Goal bounds are looked up in the table of distinct boxes
+#define MacroGoalRow m_goalRow
+#define MacroGoalCol m_goalCol
+#define MacroGoalBox(dir) m_goalBoxes[goalBounds->boxId[dir]].bounds
+#define MacroInsideFarGoalBounds(dir) true
+#else
+#define MacroGoalRow m_goalRow
+#define MacroGoalCol m_goalCol
+#define MacroGoalBox(dir) goalBounds->bounds[MacroGoalBoundsSlot(dir)]
+#define MacroInsideFarGoalBounds(dir) true
+#endif
+
 // Macro definitions for exploring in a particular direction
 #define MacroExploreDown \
-	if (m_goalRow >= map->bounds[Down][MinRow] && \
-		m_goalRow <= map->bounds[Down][MaxRow] && \
-		m_goalCol >= map->bounds[Down][MinCol] && \
-		m_goalCol <= map->bounds[Down][MaxCol]) SearchDown(currentNode, map->jumpDistance[Down]);
+	if (MacroGoalRow >= MacroGoalBox(Down)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(Down)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(Down)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(Down)[MaxCol] && \
+		MacroInsideFarGoalBounds(Down)) SearchDown(currentNode, map);
 
 #define MacroExploreDownRight \
-	if (m_goalRow >= map->bounds[DownRight][MinRow] && \
-		m_goalRow <= map->bounds[DownRight][MaxRow] && \
-		m_goalCol >= map->bounds[DownRight][MinCol] && \
-		m_goalCol <= map->bounds[DownRight][MaxCol]) SearchDownRight(currentNode, map->jumpDistance[DownRight]);
+	if (MacroGoalRow >= MacroGoalBox(DownRight)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(DownRight)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(DownRight)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(DownRight)[MaxCol] && \
+		MacroInsideFarGoalBounds(DownRight)) SearchDownRight(currentNode, map);
 
 #define MacroExploreRight \
-	if (m_goalRow >= map->bounds[Right][MinRow] && \
-		m_goalRow <= map->bounds[Right][MaxRow] && \
-		m_goalCol >= map->bounds[Right][MinCol] && \
-		m_goalCol <= map->bounds[Right][MaxCol]) SearchRight(currentNode, map->jumpDistance[Right]);
+	if (MacroGoalRow >= MacroGoalBox(Right)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(Right)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(Right)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(Right)[MaxCol] && \
+		MacroInsideFarGoalBounds(Right)) SearchRight(currentNode, map);
 
 #define MacroExploreUpRight \
-	if (m_goalRow >= map->bounds[UpRight][MinRow] && \
-		m_goalRow <= map->bounds[UpRight][MaxRow] && \
-		m_goalCol >= map->bounds[UpRight][MinCol] && \
-		m_goalCol <= map->bounds[UpRight][MaxCol]) SearchUpRight(currentNode, map->jumpDistance[UpRight]);
+	if (MacroGoalRow >= MacroGoalBox(UpRight)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(UpRight)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(UpRight)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(UpRight)[MaxCol] && \
+		MacroInsideFarGoalBounds(UpRight)) SearchUpRight(currentNode, map);
 
 #define MacroExploreUp \
-	if (m_goalRow >= map->bounds[Up][MinRow] && \
-		m_goalRow <= map->bounds[Up][MaxRow] && \
-		m_goalCol >= map->bounds[Up][MinCol] && \
-		m_goalCol <= map->bounds[Up][MaxCol]) SearchUp(currentNode, map->jumpDistance[Up]);
+	if (MacroGoalRow >= MacroGoalBox(Up)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(Up)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(Up)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(Up)[MaxCol] && \
+		MacroInsideFarGoalBounds(Up)) SearchUp(currentNode, map);
 
 #define MacroExploreUpLeft \
-	if (m_goalRow >= map->bounds[UpLeft][MinRow] && \
-		m_goalRow <= map->bounds[UpLeft][MaxRow] && \
-		m_goalCol >= map->bounds[UpLeft][MinCol] && \
-		m_goalCol <= map->bounds[UpLeft][MaxCol]) SearchUpLeft(currentNode, map->jumpDistance[UpLeft]);
+	if (MacroGoalRow >= MacroGoalBox(UpLeft)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(UpLeft)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(UpLeft)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(UpLeft)[MaxCol] && \
+		MacroInsideFarGoalBounds(UpLeft)) SearchUpLeft(currentNode, map);
 
 #define MacroExploreLeft \
-	if (m_goalRow >= map->bounds[Left][MinRow] && \
-		m_goalRow <= map->bounds[Left][MaxRow] && \
-		m_goalCol >= map->bounds[Left][MinCol] && \
-		m_goalCol <= map->bounds[Left][MaxCol]) SearchLeft(currentNode, map->jumpDistance[Left]);
+	if (MacroGoalRow >= MacroGoalBox(Left)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(Left)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(Left)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(Left)[MaxCol] && \
+		MacroInsideFarGoalBounds(Left)) SearchLeft(currentNode, map);
 
 #define MacroExploreDownLeft \
-	if (m_goalRow >= map->bounds[DownLeft][MinRow] && \
-		m_goalRow <= map->bounds[DownLeft][MaxRow] && \
-		m_goalCol >= map->bounds[DownLeft][MinCol] && \
-		m_goalCol <= map->bounds[DownLeft][MaxCol]) SearchDownLeft(currentNode, map->jumpDistance[DownLeft]);
+	if (MacroGoalRow >= MacroGoalBox(DownLeft)[MinRow] && \
+		MacroGoalRow <= MacroGoalBox(DownLeft)[MaxRow] && \
+		MacroGoalCol >= MacroGoalBox(DownLeft)[MinCol] && \
+		MacroGoalCol <= MacroGoalBox(DownLeft)[MaxCol] && \
+		MacroInsideFarGoalBounds(DownLeft)) SearchDownLeft(currentNode, map);
 
-inline const void JPSPlus::Explore_Null(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_Null(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	// Purposely does nothing
 }
 
-inline const void JPSPlus::Explore_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_DR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_DR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDownRight;
 }
 
-inline const void JPSPlus::Explore_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_UR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_UR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUpRight;
 }
 
-inline const void JPSPlus::Explore_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_UL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_UL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUpLeft;
 }
 
-inline const void JPSPlus::Explore_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_DL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_DL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDownLeft;
 }
 
 // Adjacent Doubles
 
-inline const void JPSPlus::Explore_D_DR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_DR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreDownRight;
 }
 
-inline const void JPSPlus::Explore_DR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_DR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDownRight;
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_R_UR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_UR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreUpRight;
 }
 
-inline const void JPSPlus::Explore_UR_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_UR_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUpRight;
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_U_UL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_UL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreUpLeft;
 }
 
-inline const void JPSPlus::Explore_UL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_UL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUpLeft;
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_L_DL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_DL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreDownLeft;
 }
 
-inline const void JPSPlus::Explore_DL_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_DL_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDownLeft;
 	MacroExploreDown;
@@ -412,37 +560,43 @@ inline const void JPSPlus::Explore_DL_D(PathfindingNode * currentNode, JumpDista
 
 // Non-Adjacent Cardinal Doubles
 
-inline const void JPSPlus::Explore_D_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_R_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_U_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_L_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_D_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_R_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreLeft;
@@ -450,56 +604,64 @@ inline const void JPSPlus::Explore_R_L(PathfindingNode * currentNode, JumpDistan
 
 // Adjacent Triples
 
-inline const void JPSPlus::Explore_D_DR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_DR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreDownRight;
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_DR_R_UR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_DR_R_UR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDownRight;
 	MacroExploreRight;
 	MacroExploreUpRight;
 }
 
-inline const void JPSPlus::Explore_R_UR_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_UR_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreUpRight;
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_UR_U_UL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_UR_U_UL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUpRight;
 	MacroExploreUp;
 	MacroExploreUpLeft;
 }
 
-inline const void JPSPlus::Explore_U_UL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_UL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreUpLeft;
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_UL_L_DL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_UL_L_DL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUpLeft;
 	MacroExploreLeft;
 	MacroExploreDownLeft;
 }
 
-inline const void JPSPlus::Explore_L_DL_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_DL_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreDownLeft;
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_DL_D_DR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_DL_D_DR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDownLeft;
 	MacroExploreDown;
@@ -508,28 +670,32 @@ inline const void JPSPlus::Explore_DL_D_DR(PathfindingNode * currentNode, JumpDi
 
 // Non-Adjacent Cardinal Triples
 
-inline const void JPSPlus::Explore_D_R_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_R_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreRight;
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_R_U_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_U_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreUp;
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_U_L_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_L_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreLeft;
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_L_D_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_D_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreDown;
@@ -538,7 +704,8 @@ inline const void JPSPlus::Explore_L_D_R(PathfindingNode * currentNode, JumpDist
 
 // Quads
 
-inline const void JPSPlus::Explore_R_DR_D_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_DR_D_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreDownRight;
@@ -546,7 +713,8 @@ inline const void JPSPlus::Explore_R_DR_D_L(PathfindingNode * currentNode, JumpD
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_R_D_DL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_D_DL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreDown;
@@ -554,7 +722,8 @@ inline const void JPSPlus::Explore_R_D_DL_L(PathfindingNode * currentNode, JumpD
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_U_UR_R_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_UR_R_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreUpRight;
@@ -562,7 +731,8 @@ inline const void JPSPlus::Explore_U_UR_R_D(PathfindingNode * currentNode, JumpD
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_U_R_DR_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_R_DR_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreRight;
@@ -570,7 +740,8 @@ inline const void JPSPlus::Explore_U_R_DR_D(PathfindingNode * currentNode, JumpD
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_L_UL_U_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_UL_U_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreUpLeft;
@@ -578,7 +749,8 @@ inline const void JPSPlus::Explore_L_UL_U_R(PathfindingNode * currentNode, JumpD
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_L_U_UR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_U_UR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreUp;
@@ -586,7 +758,8 @@ inline const void JPSPlus::Explore_L_U_UR_R(PathfindingNode * currentNode, JumpD
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_D_DL_L_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_DL_L_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreDownLeft;
@@ -594,7 +767,8 @@ inline const void JPSPlus::Explore_D_DL_L_U(PathfindingNode * currentNode, JumpD
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_D_L_UL_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_L_UL_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreLeft;
@@ -604,7 +778,8 @@ inline const void JPSPlus::Explore_D_L_UL_U(PathfindingNode * currentNode, JumpD
 
 // Quints
 
-inline const void JPSPlus::Explore_R_DR_D_DL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_R_DR_D_DL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreRight;
 	MacroExploreDownRight;
@@ -613,7 +788,8 @@ inline const void JPSPlus::Explore_R_DR_D_DL_L(PathfindingNode * currentNode, Ju
 	MacroExploreLeft;
 }
 
-inline const void JPSPlus::Explore_U_UR_R_DR_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_U_UR_R_DR_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreUp;
 	MacroExploreUpRight;
@@ -622,7 +798,8 @@ inline const void JPSPlus::Explore_U_UR_R_DR_D(PathfindingNode * currentNode, Ju
 	MacroExploreDown;
 }
 
-inline const void JPSPlus::Explore_L_UL_U_UR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_L_UL_U_UR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreLeft;
 	MacroExploreUpLeft;
@@ -631,7 +808,8 @@ inline const void JPSPlus::Explore_L_UL_U_UR_R(PathfindingNode * currentNode, Ju
 	MacroExploreRight;
 }
 
-inline const void JPSPlus::Explore_D_DL_L_UL_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_D_DL_L_UL_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
 {
 	MacroExploreDown;
 	MacroExploreDownLeft;
@@ -640,8 +818,21 @@ inline const void JPSPlus::Explore_D_DL_L_UL_U(PathfindingNode * currentNode, Ju
 	MacroExploreUp;
 }
 
-inline const void JPSPlus::Explore_AllDirections(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map)
-{
+template <int StrideShift>
+inline const void JPSPlus<StrideShift>::Explore_AllDirections(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds)
+{
+#ifdef DENSE_NODE_DATA
+	// Only the start node explores blocked directions, which have no goal bounds in a dense record
+	unsigned char blocked = map->blockedDirectionBitfield;
+	if ((blocked & (1 << Down)) == 0) { MacroExploreDown; }
+	if ((blocked & (1 << DownLeft)) == 0) { MacroExploreDownLeft; }
+	if ((blocked & (1 << Left)) == 0) { MacroExploreLeft; }
+	if ((blocked & (1 << UpLeft)) == 0) { MacroExploreUpLeft; }
+	if ((blocked & (1 << Up)) == 0) { MacroExploreUp; }
+	if ((blocked & (1 << UpRight)) == 0) { MacroExploreUpRight; }
+	if ((blocked & (1 << Right)) == 0) { MacroExploreRight; }
+	if ((blocked & (1 << DownRight)) == 0) { MacroExploreDownRight; }
+#else
 	MacroExploreDown;
 	MacroExploreDownLeft;
 	MacroExploreLeft;
@@ -650,12 +841,15 @@ inline const void JPSPlus::Explore_AllDirections(PathfindingNode * currentNode,
 	MacroExploreUpRight;
 	MacroExploreRight;
 	MacroExploreDownRight;
+#endif
 }
 
-void JPSPlus::SearchDown(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchDown(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[Down];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Consider straight line to Goal
 	if (col == m_goalCol && row < m_goalRow)
@@ -666,9 +860,9 @@ void JPSPlus::SearchDown(PathfindingNode * currentNode, int jumpDistance)
 		if ((row + absJumpDistance) >= m_goalRow)
 		{
 			unsigned int diff = m_goalRow - row;
-			unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
+			PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
 			PathfindingNode * newSuccessor = m_goalNode;
-			PushNewNode(newSuccessor, currentNode, Down, givenCost);
+			PushNewNode(newSuccessor, m_goalRow, m_goalCol, currentNode, Down, givenCost);
 			return;
 		}
 	}
@@ -677,16 +871,18 @@ void JPSPlus::SearchDown(PathfindingNode * currentNode, int jumpDistance)
 	{
 		// Directly jump
 		int newRow = row + jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[newRow][col];
-		PushNewNode(newSuccessor, currentNode, Down, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, Down, newRow, col);
+		PushNewNode(newSuccessor, newRow, col, currentNode, Down, givenCost);
 	}
 }
 
-void JPSPlus::SearchDownRight(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchDownRight(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[DownRight];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Check for goal in general direction (straight line to Goal or Target Jump Point)
 	if (row < m_goalRow && col < m_goalCol)
@@ -703,9 +899,9 @@ void JPSPlus::SearchDownRight(PathfindingNode * currentNode, int jumpDistance)
 		{
 			int newRow = row + smallerDiff;
 			int newCol = col + smallerDiff;
-			unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
-			PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-			PushNewNode(newSuccessor, currentNode, DownRight, givenCost);
+			PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
+			PathfindingNode * newSuccessor = GetNode(GetCellIndex(newRow, newCol, GetStride()));
+			PushNewNode(newSuccessor, newRow, newCol, currentNode, DownRight, givenCost);
 			return;
 		}
 	}
@@ -715,16 +911,18 @@ void JPSPlus::SearchDownRight(PathfindingNode * currentNode, int jumpDistance)
 		// Directly jump
 		int newRow = row + jumpDistance;
 		int newCol = col + jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-		PushNewNode(newSuccessor, currentNode, DownRight, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, DownRight, newRow, newCol);
+		PushNewNode(newSuccessor, newRow, newCol, currentNode, DownRight, givenCost);
 	}
 }
 
-void JPSPlus::SearchRight(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchRight(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[Right];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Consider straight line to Goal
 	if (row == m_goalRow && col < m_goalCol)
@@ -735,9 +933,9 @@ void JPSPlus::SearchRight(PathfindingNode * currentNode, int jumpDistance)
 		if ((col + absJumpDistance) >= m_goalCol)
 		{
 			unsigned int diff = m_goalCol - col;
-			unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
+			PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
 			PathfindingNode * newSuccessor = m_goalNode;
-			PushNewNode(newSuccessor, currentNode, Right, givenCost);
+			PushNewNode(newSuccessor, m_goalRow, m_goalCol, currentNode, Right, givenCost);
 			return;
 		}
 	}
@@ -746,16 +944,18 @@ void JPSPlus::SearchRight(PathfindingNode * currentNode, int jumpDistance)
 	{
 		// Directly jump
 		int newCol = col + jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[row][newCol];
-		PushNewNode(newSuccessor, currentNode, Right, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, Right, row, newCol);
+		PushNewNode(newSuccessor, row, newCol, currentNode, Right, givenCost);
 	}
 }
 
-void JPSPlus::SearchUpRight(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchUpRight(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[UpRight];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Check for goal in general direction (straight line to Goal or Target Jump Point)
 	if (row > m_goalRow && col < m_goalCol)
@@ -772,9 +972,9 @@ void JPSPlus::SearchUpRight(PathfindingNode * currentNode, int jumpDistance)
 		{
 			int newRow = row - smallerDiff;
 			int newCol = col + smallerDiff;
-			unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
-			PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-			PushNewNode(newSuccessor, currentNode, UpRight, givenCost);
+			PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
+			PathfindingNode * newSuccessor = GetNode(GetCellIndex(newRow, newCol, GetStride()));
+			PushNewNode(newSuccessor, newRow, newCol, currentNode, UpRight, givenCost);
 			return;
 		}
 	}
@@ -784,16 +984,18 @@ void JPSPlus::SearchUpRight(PathfindingNode * currentNode, int jumpDistance)
 		// Directly jump
 		int newRow = row - jumpDistance;
 		int newCol = col + jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-		PushNewNode(newSuccessor, currentNode, UpRight, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, UpRight, newRow, newCol);
+		PushNewNode(newSuccessor, newRow, newCol, currentNode, UpRight, givenCost);
 	}
 }
 
-void JPSPlus::SearchUp(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchUp(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[Up];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Consider straight line to Goal
 	if (col == m_goalCol && row > m_goalRow)
@@ -804,9 +1006,9 @@ void JPSPlus::SearchUp(PathfindingNode * currentNode, int jumpDistance)
 		if ((row - absJumpDistance) <= m_goalRow)
 		{
 			unsigned int diff = row - m_goalRow;
-			unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
+			PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
 			PathfindingNode * newSuccessor = m_goalNode;
-			PushNewNode(newSuccessor, currentNode, Up, givenCost);
+			PushNewNode(newSuccessor, m_goalRow, m_goalCol, currentNode, Up, givenCost);
 			return;
 		}
 	}
@@ -815,16 +1017,18 @@ void JPSPlus::SearchUp(PathfindingNode * currentNode, int jumpDistance)
 	{
 		// Directly jump
 		int newRow = row - jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[newRow][col];
-		PushNewNode(newSuccessor, currentNode, Up, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, Up, newRow, col);
+		PushNewNode(newSuccessor, newRow, col, currentNode, Up, givenCost);
 	}
 }
 
-void JPSPlus::SearchUpLeft(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchUpLeft(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[UpLeft];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Check for goal in general direction (straight line to Goal or Target Jump Point)
 	if (row > m_goalRow && col > m_goalCol)
@@ -841,9 +1045,9 @@ void JPSPlus::SearchUpLeft(PathfindingNode * currentNode, int jumpDistance)
 		{
 			int newRow = row - smallerDiff;
 			int newCol = col - smallerDiff;
-			unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
-			PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-			PushNewNode(newSuccessor, currentNode, UpLeft, givenCost);
+			PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
+			PathfindingNode * newSuccessor = GetNode(GetCellIndex(newRow, newCol, GetStride()));
+			PushNewNode(newSuccessor, newRow, newCol, currentNode, UpLeft, givenCost);
 			return;
 		}
 	}
@@ -853,16 +1057,18 @@ void JPSPlus::SearchUpLeft(PathfindingNode * currentNode, int jumpDistance)
 		// Directly jump
 		int newRow = row - jumpDistance;
 		int newCol = col - jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-		PushNewNode(newSuccessor, currentNode, UpLeft, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, UpLeft, newRow, newCol);
+		PushNewNode(newSuccessor, newRow, newCol, currentNode, UpLeft, givenCost);
 	}
 }
 
-void JPSPlus::SearchLeft(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchLeft(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[Left];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Consider straight line to Goal
 	if (row == m_goalRow && col > m_goalCol)
@@ -873,9 +1079,9 @@ void JPSPlus::SearchLeft(PathfindingNode * currentNode, int jumpDistance)
 		if ((col - absJumpDistance) <= m_goalCol)
 		{
 			unsigned int diff = col - m_goalCol;
-			unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
+			PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(diff);
 			PathfindingNode * newSuccessor = m_goalNode;
-			PushNewNode(newSuccessor, currentNode, Left, givenCost);
+			PushNewNode(newSuccessor, m_goalRow, m_goalCol, currentNode, Left, givenCost);
 			return;
 		}
 	}
@@ -884,16 +1090,18 @@ void JPSPlus::SearchLeft(PathfindingNode * currentNode, int jumpDistance)
 	{
 		// Directly jump
 		int newCol = col - jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[row][newCol];
-		PushNewNode(newSuccessor, currentNode, Left, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + FIXED_POINT_SHIFT(jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, Left, row, newCol);
+		PushNewNode(newSuccessor, row, newCol, currentNode, Left, givenCost);
 	}
 }
 
-void JPSPlus::SearchDownLeft(PathfindingNode * currentNode, int jumpDistance)
+template <int StrideShift>
+void JPSPlus<StrideShift>::SearchDownLeft(PathfindingNode * currentNode, NodeJumpDistances * map)
 {
-	int row = currentNode->m_row;
-	int col = currentNode->m_col;
+	int jumpDistance = map->jumpDistance[DownLeft];
+	int row = m_currentRow;
+	int col = m_currentCol;
 
 	// Check for goal in general direction (straight line to Goal or Target Jump Point)
 	if (row < m_goalRow && col > m_goalCol)
@@ -910,9 +1118,9 @@ void JPSPlus::SearchDownLeft(PathfindingNode * currentNode, int jumpDistance)
 		{
 			int newRow = row + smallerDiff;
 			int newCol = col - smallerDiff;
-			unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
-			PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-			PushNewNode(newSuccessor, currentNode, DownLeft, givenCost);
+			PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * smallerDiff);
+			PathfindingNode * newSuccessor = GetNode(GetCellIndex(newRow, newCol, GetStride()));
+			PushNewNode(newSuccessor, newRow, newCol, currentNode, DownLeft, givenCost);
 			return;
 		}
 	}
@@ -922,26 +1130,29 @@ void JPSPlus::SearchDownLeft(PathfindingNode * currentNode, int jumpDistance)
 		// Directly jump
 		int newRow = row + jumpDistance;
 		int newCol = col - jumpDistance;
-		unsigned int givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
-		PathfindingNode * newSuccessor = &m_mapNodes[newRow][newCol];
-		PushNewNode(newSuccessor, currentNode, DownLeft, givenCost);
+		PathCost givenCost = currentNode->m_givenCost + (SQRT_2 * jumpDistance);
+		PathfindingNode * newSuccessor = GetJumpPoint(map, DownLeft, newRow, newCol);
+		PushNewNode(newSuccessor, newRow, newCol, currentNode, DownLeft, givenCost);
 	}
 }
 
-void JPSPlus::PushNewNode(
+template <int StrideShift>
+void JPSPlus<StrideShift>::PushNewNode(
 	PathfindingNode * newSuccessor, 
+	int newRow, 
+	int newCol, 
 	PathfindingNode * currentNode, 
 	ArrayDirections parentDirection, 
-	unsigned int givenCost)
+	PathCost givenCost)
 {
 	if (newSuccessor->m_iteration != m_currentIteration)
 	{
 		// Place node on the Open list (we've never seen it before)
 
 		// Compute heuristic using octile calculation (optimized: minDiff * SQRT_2_MINUS_ONE + maxDiff)
-		unsigned int diffrow = abs(m_goalRow - newSuccessor->m_row);
-		unsigned int diffcolumn = abs(m_goalCol - newSuccessor->m_col);
-		unsigned int heuristicCost;
+		unsigned int diffrow = abs(m_goalRow - newRow);
+		unsigned int diffcolumn = abs(m_goalCol - newCol);
+		PathCost heuristicCost;
 		if (diffrow <= diffcolumn)
 		{
 			heuristicCost = (diffrow * SQRT_2_MINUS_ONE) + FIXED_POINT_SHIFT(diffcolumn);
@@ -951,7 +1162,7 @@ void JPSPlus::PushNewNode(
 			heuristicCost = (diffcolumn * SQRT_2_MINUS_ONE) + FIXED_POINT_SHIFT(diffrow);
 		}
 
-		newSuccessor->m_parent = currentNode;
+		newSuccessor->m_parent = GetNodeIndex(currentNode);
 		newSuccessor->m_directionFromParent = parentDirection;
 		newSuccessor->m_givenCost = givenCost;
 		newSuccessor->m_finalCost = givenCost + heuristicCost;
@@ -973,13 +1184,32 @@ void JPSPlus::PushNewNode(
 		// We found a cheaper way to this node - update node
 
 		// Extract heuristic cost (was previously calculated)
-		unsigned int heuristicCost = newSuccessor->m_finalCost - newSuccessor->m_givenCost;
+		PathCost heuristicCost = newSuccessor->m_finalCost - newSuccessor->m_givenCost;
 
-		newSuccessor->m_parent = currentNode;
+		newSuccessor->m_parent = GetNodeIndex(currentNode);
 		newSuccessor->m_directionFromParent = parentDirection;
 		newSuccessor->m_givenCost = givenCost;
 		newSuccessor->m_finalCost = givenCost + heuristicCost;
 
-		// No decrease key operation necessary (already in unsorted open list)
+		// The open list keeps the cost a node was added at, so add it again at the new one
+		m_simpleUnsortedPriorityQueue->DecreaseKey(newSuccessor);
 	}
-}
\ No newline at end of file
+}
+
+JPSPlusSearch* CreateJPSPlus(NodeJumpDistances* jumpDistancesMap, NodeGoalBounds* goalBoundsMap, GoalBox* goalBoxes, unsigned int* nodeDataOffsets, const BitGrid* grid)
+{
+	// One case per shift from MinCellStrideShift to MaxCellStrideShift
+	switch (GetCellStrideShift(grid->GetWidth()))
+	{
+#ifdef SPECIALIZED_CELL_STRIDES
+	case 6: return new JPSPlus<6>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	case 7: return new JPSPlus<7>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	case 8: return new JPSPlus<8>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	case 9: return new JPSPlus<9>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	case 10: return new JPSPlus<10>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	case 11: return new JPSPlus<11>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	case 12: return new JPSPlus<12>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+#endif
+	default: return new JPSPlus<0>(jumpDistancesMap, goalBoundsMap, goalBoxes, nodeDataOffsets, grid);
+	}
+}
@@ -42,11 +42,14 @@
 #include "PrecomputeMap.h"
 #include "FastStack.h"
 #include "SimpleUnsortedPriorityQueue.h"
+#include "SparseNodeTable.h"
 #include <stdint.h>
 
+//#define SPARSE_SEARCH_NODES	// Search nodes only for the cells a search touches, in a hash table (see SparseNodeTable)
+
 struct xyLocJPS {
-	int16_t x;
-	int16_t y;
+	MapCoordinate x;
+	MapCoordinate y;
 };
 
 enum PathStatus
@@ -56,105 +59,232 @@ enum PathStatus
 	NoPathExists
 };
 
+// The search as seen by its owner, whichever stride it was instantiated for (see CreateJPSPlus)
+class JPSPlusSearch
+{
+public:
+	virtual ~JPSPlusSearch() {}
+
+	virtual bool GetPath(xyLocJPS& s, xyLocJPS& g, std::vector<xyLocJPS> &path) = 0;
+};
+
+// Picks the instantiation for the map's cell stride, the precomputed data must have been loaded with it
+JPSPlusSearch* CreateJPSPlus(NodeJumpDistances* jumpDistancesMap, NodeGoalBounds* goalBoundsMap, GoalBox* goalBoxes, unsigned int* nodeDataOffsets, const BitGrid* grid);
+
 // This version of JPS+ is intimately tied with Goal Bounding.
 // Every effort has been made to maximize speed.
 // If you develop a way to improve this code or make it faster, contact steve.rabin@gmail.com
+//
+// StrideShift is the log2 of the cell stride (see GetCellStride), or 0 for a stride only known at run time.
 
-class JPSPlus
+template <int StrideShift>
+class JPSPlus : public JPSPlusSearch
 {
 public:
-	JPSPlus(JumpDistancesAndGoalBounds** jumpDistancesAndGoalBoundsMap, std::vector<bool> &rawMap, int w, int h);
+	JPSPlus(NodeJumpDistances* jumpDistancesMap, NodeGoalBounds* goalBoundsMap, GoalBox* goalBoxes, unsigned int* nodeDataOffsets, const BitGrid* grid);
 	~JPSPlus();
 
 	bool GetPath(xyLocJPS& s, xyLocJPS& g, std::vector<xyLocJPS> &path);
 
 protected:
+	typedef const void (JPSPlus::*FunctionPointer)(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
 
 	PathStatus SearchLoop(PathfindingNode* startNode);
 	void FinalizePath(std::vector<xyLocJPS> &finalPath);
 
 	// 48 function variations of exploring (used in 2048 entry look-up table)
 	// D = Down, U = Up, R = Right, L = Left, DR = Down Right, DL = Down Left, UR = Up Right, UL = Up Left
-	const void Explore_Null(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_DR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_UR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_UL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_DL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_DR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_DR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_UR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_UR_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_UL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_UL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_DL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_DL_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_DR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_DR_R_UR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_UR_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_UR_U_UL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_UL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_UL_L_DL(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_DL_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_DL_D_DR(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_R_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_U_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_L_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_D_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_DR_D_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_D_DL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_UR_R_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_R_DR_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_UL_U_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_U_UR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_DL_L_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_L_UL_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_R_DR_D_DL_L(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_U_UR_R_DR_D(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_L_UL_U_UR_R(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_D_DL_L_UL_U(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-	const void Explore_AllDirections(PathfindingNode * currentNode, JumpDistancesAndGoalBounds * map);
-
-	void SearchDown(PathfindingNode * currentNode, int jumpDistance);
-	void SearchDownRight(PathfindingNode * currentNode, int jumpDistance);
-	void SearchRight(PathfindingNode * currentNode, int jumpDistance);
-	void SearchUpRight(PathfindingNode * currentNode, int jumpDistance);
-	void SearchUp(PathfindingNode * currentNode, int jumpDistance);
-	void SearchUpLeft(PathfindingNode * currentNode, int jumpDistance);
-	void SearchLeft(PathfindingNode * currentNode, int jumpDistance);
-	void SearchDownLeft(PathfindingNode * currentNode, int jumpDistance);
-
-	void PushNewNode(PathfindingNode * newSuccessor, PathfindingNode * currentNode, ArrayDirections parentDirection, unsigned int givenCost);
+	const void Explore_Null(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_DR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_UR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_UL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_DL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_DR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_DR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_UR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_UR_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_UL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_UL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_DL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_DL_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_DR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_DR_R_UR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_UR_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_UR_U_UL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_UL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_UL_L_DL(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_DL_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_DL_D_DR(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_R_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_U_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_L_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_D_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_DR_D_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_D_DL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_UR_R_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_R_DR_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_UL_U_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_U_UR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_DL_L_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_L_UL_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_R_DR_D_DL_L(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_U_UR_R_DR_D(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_L_UL_U_UR_R(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_D_DL_L_UL_U(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+	const void Explore_AllDirections(PathfindingNode * currentNode, NodeJumpDistances * map, NodeGoalBounds * goalBounds);
+
+	void SearchDown(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchDownRight(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchRight(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchUpRight(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchUp(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchUpLeft(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchLeft(PathfindingNode * currentNode, NodeJumpDistances * map);
+	void SearchDownLeft(PathfindingNode * currentNode, NodeJumpDistances * map);
+
+	inline PathfindingNode* GetNode(unsigned int index)
+	{
+#ifdef SPARSE_SEARCH_NODES
+		return m_sparseNodes->GetNode(index);
+#else
+		return &m_mapNodes[index];
+#endif
+	}
+
+	inline unsigned int GetNodeIndex(PathfindingNode * node)
+	{
+#ifdef SPARSE_SEARCH_NODES
+		return m_sparseNodes->GetCellIndex(node);
+#else
+		return (unsigned int)(node - m_mapNodes);
+#endif
+	}
+
+	// A constant for the specialized instantiations, so the index math is shifts and masks
+	inline int GetStride() { return StrideShift != 0 ? 1 << StrideShift : m_cellStride; }
+
+	// Nodes don't store their row and col, they follow from the node's index
+	inline int GetRow(PathfindingNode * node) { return GetCellRow(GetNodeIndex(node), GetStride()); }
+	inline int GetCol(PathfindingNode * node) { return GetCellCol(GetNodeIndex(node), GetStride()); }
+
+	inline unsigned int SetCurrentNode(PathfindingNode * currentNode)
+	{
+		unsigned int index = GetNodeIndex(currentNode);
+		m_currentRow = GetCellRow(index, GetStride());
+		m_currentCol = GetCellCol(index, GetStride());
+		return index;
+	}
+
+	inline NodeJumpDistances* GetJumpDistances(unsigned int index)
+	{
+#ifdef DENSE_NODE_DATA
+		return (NodeJumpDistances*)((unsigned char*)m_jumpDistances + m_nodeDataOffsets[index]);
+#else
+		return &m_jumpDistances[index];
+#endif
+	}
+
+	inline PathfindingNode* GetJumpPoint(NodeJumpDistances * map, ArrayDirections dir, int row, int col)
+	{
+#ifdef SUCCESSOR_CELL_INDICES
+		return GetNode(map->jumpPointIndex[dir]);
+#else
+		return GetNode(GetCellIndex(row, col, GetStride()));
+#endif
+	}
+
+	inline NodeGoalBounds* GetGoalBounds(unsigned int index)
+	{
+#ifdef SPLIT_HOT_COLD_NODE_DATA
+		return &m_goalBounds[index];
+#elif defined(DENSE_NODE_DATA)
+		return GetJumpDistances(index);
+#else
+		return &m_jumpDistances[index].goalBounds;
+#endif
+	}
+
+#ifdef COMPRESSED_GOAL_BOUNDS
+	inline void SetGoalOffsets(PathfindingNode * currentNode)
+	{
+		m_goalRowOffset = SaturateGoalBoundsOffset(m_goalRow - m_currentRow);
+		m_goalColOffset = SaturateGoalBoundsOffset(m_goalCol - m_currentCol);
+		m_goalIsFar = m_goalRowOffset == -128 || m_goalRowOffset == 127 || 
+			m_goalColOffset == -128 || m_goalColOffset == 127;
+	}
+
+	inline bool IsInsideFarGoalBounds(NodeGoalBounds * goalBounds, int dir)
+	{
+		// The node's far boxes are stored in direction order, so skip the ones before dir
+		unsigned int before = goalBounds->farBoundsBitfield & ((1 << dir) - 1);
+		before = before - ((before >> 1) & 0x55);
+		before = (before & 0x33) + ((before >> 2) & 0x33);
+		before = (before + (before >> 4)) & 0x0F;
+
+		const MapCoordinate* box = m_goalBoxes[goalBounds->farBoundsIndex + before].bounds;
+		return m_goalRow >= box[MinRow] && m_goalRow <= box[MaxRow] &&
+			m_goalCol >= box[MinCol] && m_goalCol <= box[MaxCol];
+	}
+#endif
+
+	void NextIteration();
+	void PushNewNode(PathfindingNode * newSuccessor, int newRow, int newCol, PathfindingNode * currentNode, ArrayDirections parentDirection, PathCost givenCost);
 
 	// 2D array initialization and destruction
-	template <typename T> void InitArray(T**& t, int width, int height);
-	template <typename T> void DestroyArray(T**& t);
+	template <typename T> void InitArray(T*& t, int width, int height);
+	template <typename T> void DestroyArray(T*& t);
 
 	// Map properties
 	int m_width, m_height;
+	int m_cellStride;
+	const BitGrid* m_grid;	// Owned, shared with preprocessing
 
 	// Open list structures
 	FastStack* m_fastStack;
 	SimpleUnsortedPriorityQueue* m_simpleUnsortedPriorityQueue;
 
 	// Precomputed data
-	JumpDistancesAndGoalBounds** m_jumpDistancesAndGoalBounds;
+	NodeJumpDistances* m_jumpDistances;
+	NodeGoalBounds* m_goalBounds;	// Only when split, otherwise inside the jump distances
+	GoalBox* m_goalBoxes;			// Only when compressed (far boxes) or dictionary encoded (all boxes)
+#ifdef DENSE_NODE_DATA
+	unsigned int* m_nodeDataOffsets;			// Byte offset of each open cell's record
+	unsigned char m_goalBoundsSlot[256][8];		// Where a direction's goal bounds are, by blocked directions
+#endif
 
-	// Preallocated nodes
-	PathfindingNode** m_mapNodes;
+	// Preallocated nodes (one per cell), or only the touched ones
+#ifdef SPARSE_SEARCH_NODES
+	SparseNodeTable* m_sparseNodes;
+#else
+	PathfindingNode* m_mapNodes;
+#endif
 
 	// Search specific info
 	unsigned short m_currentIteration;	// This allows us to know if a node has been touched this iteration (faster than clearing all the nodes before each search)
+#ifndef SPARSE_SEARCH_NODES
+	unsigned int m_numNodes;			// Including the layout padding
+	unsigned int m_staleNodeCursor;		// Next node to reset (see NextIteration)
+	unsigned int m_staleNodesPerSearch;
+#endif
 	PathfindingNode* m_goalNode;
 	int m_goalRow, m_goalCol;
+	int m_currentRow, m_currentCol;	// Of the node being expanded
+#ifdef COMPRESSED_GOAL_BOUNDS
+	int m_goalRowOffset, m_goalColOffset;	// Saturated goal position relative to the current node
+	bool m_goalIsFar;						// Either offset is saturated
+#elif defined(QUANTIZED_GOAL_BOUNDS)
+	int m_goalRowTile, m_goalColTile;		// Goal position in goal bounds tiles
+	int m_tileShift;
+#endif
 };
 
@@ -0,0 +1,198 @@
+/*
+ * LargePageArray.cpp
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include "stdafx.h"
+#include <malloc.h>
+#include <string.h>
+#include "LargePageArray.h"
+#ifdef LARGE_PAGE_ARRAYS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+#ifdef LARGE_PAGE_ARRAYS
+// Large blocks get their own mapping, with a header in front of the returned memory that says
+// how to release it (one cache line, so the array stays cache line aligned).
+//
+// Windows: large pages need the "Lock pages in memory" privilege, which is enabled on first use.
+// Without it the block is mapped with normal pages.
+// Linux: MAP_HUGETLB needs pages reserved in vm.nr_hugepages. Without them the block is mapped
+// 2 MB aligned and madvise asks for transparent huge pages (THP "madvise" or "always" mode).
+// Blocks smaller than a large page stay on the heap, a large page would mostly be wasted.
+
+static const size_t LargePageSize = 2 * 1024 * 1024;
+static const size_t HeaderSize = 64;
+
+struct ArrayMemoryHeader
+{
+	void* mapping;			// Start of the mapping, or 0 if the block is on the heap
+	size_t mappingBytes;
+};
+
+#ifdef _WIN32
+static size_t GetLargePageBytes()
+{
+	static size_t largePageBytes = (size_t)-1;
+	if (largePageBytes == (size_t)-1)
+	{
+		largePageBytes = 0;
+		HANDLE token;
+		if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		{
+			TOKEN_PRIVILEGES privileges;
+			privileges.PrivilegeCount = 1;
+			privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+			if (LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+				AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL) &&
+				GetLastError() == ERROR_SUCCESS)
+			{
+				largePageBytes = GetLargePageMinimum();
+			}
+			CloseHandle(token);
+		}
+	}
+	return largePageBytes;
+}
+
+static void* MapLargePages(size_t bytes, size_t& mappingBytes)
+{
+	size_t largePageBytes = GetLargePageBytes();
+	if (largePageBytes != 0)
+	{
+		mappingBytes = (bytes + largePageBytes - 1) & ~(largePageBytes - 1);
+		void* mapping = VirtualAlloc(NULL, mappingBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (mapping != NULL)
+		{
+			return mapping;
+		}
+	}
+
+	mappingBytes = bytes;
+	return VirtualAlloc(NULL, mappingBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+static void UnmapLargePages(void* mapping, size_t mappingBytes)
+{
+	VirtualFree(mapping, 0, MEM_RELEASE);
+}
+#else
+static void* MapLargePages(size_t bytes, size_t& mappingBytes)
+{
+	mappingBytes = (bytes + LargePageSize - 1) & ~(LargePageSize - 1);
+	void* mapping = mmap(NULL, mappingBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (mapping != MAP_FAILED)
+	{
+		return mapping;
+	}
+
+	// Over-map by one large page, then trim so the mapping starts on a large page boundary
+	unsigned char* region = (unsigned char*)mmap(NULL, mappingBytes + LargePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (region == (unsigned char*)MAP_FAILED)
+	{
+		return 0;
+	}
+	size_t head = (LargePageSize - ((size_t)region & (LargePageSize - 1))) & (LargePageSize - 1);
+	if (head > 0)
+	{
+		munmap(region, head);
+	}
+	munmap(region + head + mappingBytes, LargePageSize - head);
+	mapping = region + head;
+	madvise(mapping, mappingBytes, MADV_HUGEPAGE);
+	return mapping;
+}
+
+static void UnmapLargePages(void* mapping, size_t mappingBytes)
+{
+	munmap(mapping, mappingBytes);
+}
+#endif
+
+void* AllocateArrayMemory(size_t bytes)
+{
+	unsigned char* block = 0;
+	ArrayMemoryHeader header = { 0, 0 };
+	if (bytes + HeaderSize >= LargePageSize)
+	{
+		header.mapping = MapLargePages(bytes + HeaderSize, header.mappingBytes);
+		block = (unsigned char*)header.mapping;
+	}
+	if (block == 0)
+	{
+		header.mapping = 0;
+		block = (unsigned char*)_aligned_malloc(bytes + HeaderSize, 64);
+	}
+
+	memcpy(block, &header, sizeof(header));
+	return block + HeaderSize;
+}
+
+void FreeArrayMemory(void* memory)
+{
+	if (memory == 0)
+	{
+		return;
+	}
+
+	unsigned char* block = (unsigned char*)memory - HeaderSize;
+	ArrayMemoryHeader header;
+	memcpy(&header, block, sizeof(header));
+	if (header.mapping != 0)
+	{
+		UnmapLargePages(header.mapping, header.mappingBytes);
+	}
+	else
+	{
+		_aligned_free(block);
+	}
+}
+#else
+void* AllocateArrayMemory(size_t bytes)
+{
+	return _aligned_malloc(bytes, 64);
+}
+
+void FreeArrayMemory(void* memory)
+{
+	_aligned_free(memory);
+}
+#endif
@@ -0,0 +1,58 @@
+/*
+ * MapTypes.h
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#pragma once
+#include <stdint.h>
+
+//#define LARGE_MAP_MODE	// 32-bit coordinates and jump distances, 64-bit path costs (see below)
+
+// The types that bound the map size. The default keeps every record compact: coordinates, jump
+// distances and goal bounds in 16 bits and path costs in 32 bits. That handles maps up to
+// 32767 cells on a side, with flood paths up to 42949 cells long (costs are 100000 per cell)
+// and search paths up to 1.8 million cells (2378 per cell).
+// The large map mode widens them to 32 and 64 bits. Cell indices are 32 bits in both modes,
+// so maps can grow to 46340x46340. That costs memory: the search nodes grow from 16 to 24 bytes,
+// and the per-node records and the .pre file (written in the same widths) grow as well.
+#ifdef LARGE_MAP_MODE
+typedef int32_t MapCoordinate;		// A row, col, jump distance or goal bound
+typedef uint64_t PathCost;			// A fixed point cost, in the search and in the floods
+#else
+typedef int16_t MapCoordinate;
+typedef uint32_t PathCost;
+#endif
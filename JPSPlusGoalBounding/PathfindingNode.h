@@ -39,15 +39,17 @@
 
 #pragma once
 #include "stdafx.h"
+#include "MapTypes.h"
 
+// 16 bytes, so four nodes share a cache line (24 bytes in the large map mode). A node's row
+// and col aren't stored, they follow from its index in the search's node array (see GetCellIndex).
 struct PathfindingNode
 {
 public:
-	PathfindingNode* m_parent;
-	short m_row, m_col;
-	unsigned int m_givenCost;
-	unsigned int m_finalCost;
-	unsigned int m_iteration;
+	unsigned int m_parent;	// Index of the parent node
+	PathCost m_givenCost;
+	PathCost m_finalCost;
+	unsigned short m_iteration;	// Stamp of the last search that touched it, 0 for none (see NextIteration)
 	unsigned char m_directionFromParent;
 
 	enum PathfindingNodeStatus
@@ -58,25 +60,6 @@ public:
 	};
 
 	unsigned char m_listStatus;
-};
 
-struct DijkstraPathfindingNode
-{
-public:
-	DijkstraPathfindingNode* m_parent;
-	short m_row, m_col;
-	unsigned int m_givenCost;
-	unsigned int m_iteration;
-	unsigned char m_directionFromStart;
-	unsigned char m_directionFromParent;
-	unsigned char m_blockedDirectionBitfield;	// highest bit [DownLeft, Left, UpLeft, Up, UpRight, Right, DownRight, Down] lowest bit
-
-	enum PathfindingNodeStatus
-	{
-		OnNone,
-		OnOpen,
-		OnClosed
-	};
-
-	unsigned char m_listStatus;
+	static const unsigned int NoParent = 0xFFFFFFFF;
 };
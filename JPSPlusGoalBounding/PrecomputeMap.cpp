@@ -39,9 +39,18 @@
 
 #include "stdafx.h"
 #include "PrecomputeMap.h"
+#include "LargePageArray.h"
 #include "DijkstraFloodfill.h"
 #include "JPSPlus.h"
+#include "Timer.h"
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <stdint.h>
+#include <malloc.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using std::ifstream;
 using std::ofstream;
@@ -49,152 +58,250 @@ using std::ofstream;
 //#define FILE_FORMAT_ASCII
 #define INVALID_GOAL_BOUNDS -1
 
-PrecomputeMap::PrecomputeMap(int width, int height, std::vector<bool> map)
-: m_mapCreated(false), m_width(width), m_height(height), m_map(map)
+PrecomputeMap::PrecomputeMap(const BitGrid* grid)
+: m_mapCreated(false), m_width(grid->GetWidth()), m_height(grid->GetHeight()), m_cellStride(GetCellStride(grid->GetWidth())), m_grid(grid)
 {
+	memset(&m_stats, 0, sizeof(m_stats));
 }
 
 PrecomputeMap::~PrecomputeMap()
 {
 }
 
-DistantJumpPoints** PrecomputeMap::CalculateMap()
+void PrecomputeMap::CalculateMap(const char *filename)
 {
 	m_mapCreated = true;
+	Timer timer;
 
+	timer.StartTimer();
 	InitArray(m_jumpPointMap, m_width, m_height);
 	CalculateJumpPointMap();
+	timer.EndTimer();
+	m_stats.jumpPointSeconds = timer.GetElapsedSeconds();
 
+	timer.StartTimer();
 	InitArray(m_distantJumpPointMap, m_width, m_height);
 	CalculateDistantJumpPointMap();
+	timer.EndTimer();
+	m_stats.distantJumpPointSeconds = timer.GetElapsedSeconds();
 
 	// Destroy the m_jumpPointMap since it isn't needed for the search
 	DestroyArray(m_jumpPointMap);
 
-	// Calculate Goal Bounds
+	// Calculate Goal Bounds (each row is saved as soon as it is done)
 	//CalculateGoalBoundingDEPRECATED();
-	CalculateGoalBounding();
+	timer.StartTimer();
+	CalculateGoalBounding(filename, 0, 0);
+	timer.EndTimer();
+	m_stats.goalBoundingSeconds = timer.GetElapsedSeconds();
+}
+
+void PrecomputeMap::CalculateMapIncremental(const BitGrid* oldGrid, const char *oldFilename, const char *filename)
+{
+	m_mapCreated = true;
+	Timer timer;
 
-	return m_distantJumpPointMap;
+	// Jump distances are linear in the map size, so they are simply redone
+	timer.StartTimer();
+	InitArray(m_jumpPointMap, m_width, m_height);
+	CalculateJumpPointMap();
+	timer.EndTimer();
+	m_stats.jumpPointSeconds = timer.GetElapsedSeconds();
+
+	timer.StartTimer();
+	InitArray(m_distantJumpPointMap, m_width, m_height);
+	CalculateDistantJumpPointMap();
+	timer.EndTimer();
+	m_stats.distantJumpPointSeconds = timer.GetElapsedSeconds();
+
+	DestroyArray(m_jumpPointMap);
+
+	// Only the floods that can see the changed cells are redone
+	timer.StartTimer();
+	CalculateGoalBounding(filename, oldGrid, oldFilename);
+	timer.EndTimer();
+	m_stats.goalBoundingSeconds = timer.GetElapsedSeconds();
 }
 
-void PrecomputeMap::SaveMap(const char *filename)
+void PrecomputeMap::ReleaseMap()
+{
+	if (m_mapCreated)
+	{
+		DestroyArray(m_distantJumpPointMap);
+	}
+}
+
+void PrecomputeMap::SaveRow(std::ostream& file, int r, GoalBounds* rowBounds)
 {
 #ifdef FILE_FORMAT_ASCII
-	ofstream file(filename);
+	for (int c = 0; c < m_width; c++)
+	{
+		DistantJumpPoints* jumpPoints = &m_distantJumpPointMap[r * m_width + c];
 
-	for (int r = 0; r < m_height; r++)
+		for (int i = 0; i < 8; i++)
+		{
+			file << (int)jumpPoints->jumpDistance[i] << "\t";
+		}
+		for (int dir = 0; dir < 8; dir++)
+		{
+			for (int minMaxIndex = 0; minMaxIndex < 4; minMaxIndex++)
+			{
+				file << (int)rowBounds[c].bounds[dir][minMaxIndex] << "\t";
+			}
+		}
+		file << std::endl;
+	}
+	file << std::endl;
+#else
+	for (int c = 0; c < m_width; c++)
 	{
-		for (int c = 0; c < m_width; c++)
+		if (IsWall(r, c))
 		{
-			DistantJumpPoints* jumpPoints = &m_distantJumpPointMap[r][c];
+			// Don't save data if a wall
+			continue;
+		}
 
-			for (int i = 0; i < 8; i++)
+		// Save Jump Distances
+		DistantJumpPoints* jumpPoints = &m_distantJumpPointMap[r * m_width + c];
+
+		for (int i = 0; i < 8; i++)
+		{
+			file.write((char*)&jumpPoints->jumpDistance[i], sizeof(MapCoordinate));
+		}
+
+		// Save Goal Bounds
+		for (int dir = 0; dir < 8; dir++)
+		{
+			if ((rowBounds[c].bounds[dir][MinRow] > 
+				 rowBounds[c].bounds[dir][MaxRow]) &&
+				(rowBounds[c].bounds[dir][MinCol] > 
+				 rowBounds[c].bounds[dir][MaxCol]))
 			{
-				file << (int)jumpPoints->jumpDistance[i] << "\t";
+				// Use INVALID_GOAL_BOUNDS to represent all four values for compression
+				MapCoordinate value = INVALID_GOAL_BOUNDS;
+				file.write((char*)&value, sizeof(MapCoordinate));
 			}
-			for (int dir = 0; dir < 8; dir++)
+			else
 			{
 				for (int minMaxIndex = 0; minMaxIndex < 4; minMaxIndex++)
 				{
-					file << (int)m_goalBoundsMap[r][c].bounds[dir][minMaxIndex] << "\t";
+					MapCoordinate value = rowBounds[c].bounds[dir][minMaxIndex];
+					file.write((char*)&value, sizeof(MapCoordinate));
 				}
 			}
-			file << std::endl;
 		}
-		file << std::endl;
 	}
-#else
-	ofstream file(filename, std::ios::out | std::ios::binary);
+#endif
+}
 
-	for (int r = 0; r < m_height; r++)
+void PrecomputeMap::LoadRow(std::istream& file, int r, const BitGrid* grid, GoalBounds* rowBounds)
+{
+	// Reads back one row written by SaveRow (the jump distances are skipped)
+	for (int c = 0; c < m_width; c++)
 	{
-		for (int c = 0; c < m_width; c++)
+		for (int dir = 0; dir < 8; dir++)
 		{
-			if (IsWall(r, c))
+			rowBounds[c].bounds[dir][MinRow] = m_height;
+			rowBounds[c].bounds[dir][MaxRow] = 0;
+			rowBounds[c].bounds[dir][MinCol] = m_width;
+			rowBounds[c].bounds[dir][MaxCol] = 0;
+		}
+
+#ifdef FILE_FORMAT_ASCII
+		int value;
+		for (int i = 0; i < 8; i++)
+		{
+			file >> value;
+		}
+		for (int dir = 0; dir < 8; dir++)
+		{
+			for (int minMaxIndex = 0; minMaxIndex < 4; minMaxIndex++)
 			{
-				// Don't save data if a wall
-				continue;
+				file >> value;
+				rowBounds[c].bounds[dir][minMaxIndex] = value;
 			}
+		}
+#else
+		if (grid->IsWall(r, c))
+		{
+			// No data saved for a wall
+			continue;
+		}
 
-			// Save Jump Distances
-			DistantJumpPoints* jumpPoints = &m_distantJumpPointMap[r][c];
+		file.ignore(8 * sizeof(MapCoordinate));
 
-			for (int i = 0; i < 8; i++)
-			{
-				file.write((char*)&jumpPoints->jumpDistance[i], 2);
-			}
+		for (int dir = 0; dir < 8; dir++)
+		{
+			MapCoordinate value;
+			file.read((char*)&value, sizeof(MapCoordinate));
 
-			// Save Goal Bounds
-			for (int dir = 0; dir < 8; dir++)
+			if (value != INVALID_GOAL_BOUNDS)
 			{
-				if ((m_goalBoundsMap[r][c].bounds[dir][MinRow] > 
-					 m_goalBoundsMap[r][c].bounds[dir][MaxRow]) &&
-					(m_goalBoundsMap[r][c].bounds[dir][MinCol] > 
-					 m_goalBoundsMap[r][c].bounds[dir][MaxCol]))
-				{
-					// Use INVALID_GOAL_BOUNDS to represent all four values for compression
-					short value = INVALID_GOAL_BOUNDS;
-					file.write((char*)&value, 2);
-				}
-				else
-				{
-					for (int minMaxIndex = 0; minMaxIndex < 4; minMaxIndex++)
-					{
-						short value = m_goalBoundsMap[r][c].bounds[dir][minMaxIndex];
-						file.write((char*)&value, 2);
-					}
-				}
+				rowBounds[c].bounds[dir][MinRow] = value;
+				file.read((char*)&rowBounds[c].bounds[dir][MaxRow], sizeof(MapCoordinate));
+				file.read((char*)&rowBounds[c].bounds[dir][MinCol], sizeof(MapCoordinate));
+				file.read((char*)&rowBounds[c].bounds[dir][MaxCol], sizeof(MapCoordinate));
 			}
 		}
-	}
 #endif
+	}
 }
 
 void PrecomputeMap::LoadMap(const char *filename)
 {
 	m_mapCreated = true;
 
+	int layoutWidth = GetCellLayoutWidth(m_cellStride);
+	int layoutHeight = GetCellLayoutHeight(m_height);
+#ifdef DENSE_NODE_DATA
+	InitArray(m_nodeDataOffsets, layoutWidth, layoutHeight);
+#else
+	InitArray(m_jumpDistancesMap, layoutWidth, layoutHeight);
+	m_nodeDataOffsets = 0;
+#endif
+#ifdef SPLIT_HOT_COLD_NODE_DATA
+	InitArray(m_goalBoundsMap, layoutWidth, layoutHeight);
+#else
+	m_goalBoundsMap = 0;
+#endif
+	std::vector<GoalBox> goalBoxes;
+#ifdef DICTIONARY_GOAL_BOUNDS
+	// Reserved ids (min above max, so nothing passes the empty box)
+	GoalBox emptyBox = { { (MapCoordinate)m_height, 0, (MapCoordinate)m_width, 0 } };
+	GoalBox wholeMapBox = { { 0, (MapCoordinate)(m_height - 1), 0, (MapCoordinate)(m_width - 1) } };
+	goalBoxes.push_back(emptyBox);
+	goalBoxes.push_back(wholeMapBox);
+	m_goalBoxIds[GetGoalBoxKey(wholeMapBox.bounds)] = WholeMapGoalBox;
+#endif
+
+	DistantJumpPoints jumpPoints;
+	GoalBounds bounds;
+
 #ifdef FILE_FORMAT_ASCII
 	ifstream file(filename, std::ios::in);
 
-	InitArray(m_jumpDistancesAndGoalBoundsMap, m_width, m_height);
-
 	for (int r = 0; r < m_height; r++)
 	{
 		for (int c = 0; c < m_width; c++)
 		{
-			JumpDistancesAndGoalBounds* map = &m_jumpDistancesAndGoalBoundsMap[r][c];
-			map->blockedDirectionBitfield = 0;
-
 			for (int i = 0; i < 8; i++)
 			{
-				file >> map->jumpDistance[i];
-			}
-			for (int i = 0; i < 8; i++)
-			{
-				// Detect invalid movement from jump distances
-				// (jump distance of zero is invalid movement)
-				if(map->jumpDistance[i] == 0)
-				{
-					map->blockedDirectionBitfield |= (1 << i);
-				}
+				file >> jumpPoints.jumpDistance[i];
 			}
 			for (int dir = 0; dir < 8; dir++)
 			{
-				file >> m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MinRow];
-				file >> m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MaxRow];
-				file >> m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MinCol];
-				file >> m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MaxCol];
+				file >> bounds.bounds[dir][MinRow];
+				file >> bounds.bounds[dir][MaxRow];
+				file >> bounds.bounds[dir][MinCol];
+				file >> bounds.bounds[dir][MaxCol];
 			}
 
+			StoreNodeData(r, c, jumpPoints, bounds, goalBoxes);
 		}
 	}
 #else
 	ifstream file(filename, std::ios::in | std::ios::binary);
 
-	InitArray(m_jumpDistancesAndGoalBoundsMap, m_width, m_height);
-
 	for (int r = 0; r < m_height; r++)
 	{
 		for (int c = 0; c < m_width; c++)
@@ -205,143 +312,312 @@ void PrecomputeMap::LoadMap(const char *filename)
 				continue;
 			}
 
-			JumpDistancesAndGoalBounds* map = &m_jumpDistancesAndGoalBoundsMap[r][c];
-			map->blockedDirectionBitfield = 0;
-
 			// Load Jump Distances
 			for (int i = 0; i < 8; i++)
 			{
-				file.read((char*)&map->jumpDistance[i], 2);
-			}
-
-			// Fabricate wall bitfield for each node
-			for (int i = 0; i < 8; i++)
-			{
-				// Jump distance of zero is invalid movement and means a wall
-				if(map->jumpDistance[i] == 0)
-				{
-					map->blockedDirectionBitfield |= (1 << i);
-				}
+				file.read((char*)&jumpPoints.jumpDistance[i], sizeof(MapCoordinate));
 			}
 
 			// Load Goal Bounds
 			for (int dir = 0; dir < 8; dir++)
 			{
-				short value;
-				file.read((char*)&value, 2);
+				MapCoordinate value;
+				file.read((char*)&value, sizeof(MapCoordinate));
 
 				if(value == INVALID_GOAL_BOUNDS)
 				{
-					m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MinRow] = m_height;
-					m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MaxRow] = 0;
-					m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MinCol] = m_width;
-					m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MaxCol] = 0;
+					bounds.bounds[dir][MinRow] = m_height;
+					bounds.bounds[dir][MaxRow] = 0;
+					bounds.bounds[dir][MinCol] = m_width;
+					bounds.bounds[dir][MaxCol] = 0;
 				}
 				else
 				{
-					m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MinRow] = value;
-					file.read((char*)&m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MaxRow], 2);
-					file.read((char*)&m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MinCol], 2);
-					file.read((char*)&m_jumpDistancesAndGoalBoundsMap[r][c].bounds[dir][MaxCol], 2);
+					bounds.bounds[dir][MinRow] = value;
+					file.read((char*)&bounds.bounds[dir][MaxRow], sizeof(MapCoordinate));
+					file.read((char*)&bounds.bounds[dir][MinCol], sizeof(MapCoordinate));
+					file.read((char*)&bounds.bounds[dir][MaxCol], sizeof(MapCoordinate));
 				}
 			}
 
+			StoreNodeData(r, c, jumpPoints, bounds, goalBoxes);
 		}
 	}
 #endif
+
+	// Side table for the compressed goal bounds that didn't fit, or for every distinct box
+	// when dictionary encoded (handed to the search with the rest)
+	m_goalBoxes = new GoalBox[goalBoxes.size()];
+	if (!goalBoxes.empty())
+	{
+		memcpy(m_goalBoxes, &goalBoxes[0], sizeof(GoalBox) * goalBoxes.size());
+	}
+#ifdef DICTIONARY_GOAL_BOUNDS
+	std::unordered_map<uint64_t, unsigned int>().swap(m_goalBoxIds);
+#endif
+#ifdef DENSE_NODE_DATA
+	// Move the records into one cache line aligned block
+	m_jumpDistancesMap = (NodeJumpDistances*)AllocateArrayMemory(m_denseNodeData.size());
+	if (!m_denseNodeData.empty())
+	{
+		memcpy(m_jumpDistancesMap, &m_denseNodeData[0], m_denseNodeData.size());
+	}
+	std::vector<unsigned char>().swap(m_denseNodeData);
+#endif
 }
 
-template <typename T>
-void PrecomputeMap::InitArray(T**& t, int width, int height)
+void PrecomputeMap::StoreNodeData(int r, int c, const DistantJumpPoints& jumpPoints, const GoalBounds& bounds, std::vector<GoalBox>& goalBoxes)
 {
-	t = new T*[height];
-	for (int i = 0; i < height; ++i)
+#ifdef DENSE_NODE_DATA
+	if (IsWall(r, c))
+	{
+		// Walls have no record
+		return;
+	}
+
+	// Filled in full, then only its open directions are appended to the records
+	DenseNodeData record;
+	memset(&record, 0, sizeof(record));
+	NodeJumpDistances* map = &record;
+	NodeGoalBounds* goalBounds = &record;
+#else
+	NodeJumpDistances* map = &m_jumpDistancesMap[GetCellIndex(r, c, m_cellStride)];
+#ifdef SPLIT_HOT_COLD_NODE_DATA
+	NodeGoalBounds* goalBounds = &m_goalBoundsMap[GetCellIndex(r, c, m_cellStride)];
+#else
+	NodeGoalBounds* goalBounds = &map->goalBounds;
+#endif
+#endif
+
+	map->blockedDirectionBitfield = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		map->jumpDistance[i] = jumpPoints.jumpDistance[i];
+
+		// Fabricate wall bitfield for each node
+		// (jump distance of zero is invalid movement and means a wall)
+		if (map->jumpDistance[i] == 0)
+		{
+			map->blockedDirectionBitfield |= (1 << i);
+		}
+	}
+
+#ifdef SUCCESSOR_CELL_INDICES
+	static const int offsetRow[] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+	static const int offsetCol[] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+	for (int i = 0; i < 8; i++)
+	{
+		// Positive distances lead to a jump point, negative ones stop before a wall
+		int distance = abs(map->jumpDistance[i]);
+		map->jumpPointIndex[i] = GetCellIndex(r + offsetRow[i] * distance, c + offsetCol[i] * distance, m_cellStride);
+	}
+#endif
+
+#ifdef COMPRESSED_GOAL_BOUNDS
+	goalBounds->farBoundsBitfield = 0;
+	goalBounds->farBoundsIndex = (int)goalBoxes.size();
+
+	for (int dir = 0; dir < 8; dir++)
+	{
+		const MapCoordinate* box = bounds.bounds[dir];
+		signed char* relativeBox = goalBounds->bounds[dir];
+
+		if (box[MinRow] > box[MaxRow] || box[MinCol] > box[MaxCol])
+		{
+			// Empty box
+			relativeBox[MinRow] = relativeBox[MinCol] = 127;
+			relativeBox[MaxRow] = relativeBox[MaxCol] = -128;
+			continue;
+		}
+
+		int offsets[4] = { box[MinRow] - r, box[MaxRow] - r, box[MinCol] - c, box[MaxCol] - c };
+		bool far = false;
+		for (int i = 0; i < 4; i++)
+		{
+			far |= offsets[i] < -127 || offsets[i] > 126;
+			relativeBox[i] = (signed char)SaturateGoalBoundsOffset(offsets[i]);
+		}
+
+		if (far)
+		{
+			GoalBox farBox = { { box[MinRow], box[MaxRow], box[MinCol], box[MaxCol] } };
+			goalBounds->farBoundsBitfield |= (1 << dir);
+			goalBoxes.push_back(farBox);
+		}
+	}
+#elif defined(QUANTIZED_GOAL_BOUNDS)
+	int tileShift = GetGoalBoundsTileShift(m_width, m_height);
+
+	for (int dir = 0; dir < 8; dir++)
+	{
+		const MapCoordinate* box = bounds.bounds[dir];
+		unsigned char* quantizedBox = goalBounds->bounds[dir];
+
+		if (box[MinRow] > box[MaxRow] || box[MinCol] > box[MaxCol])
+		{
+			// Empty box
+			quantizedBox[MinRow] = quantizedBox[MinCol] = 255;
+			quantizedBox[MaxRow] = quantizedBox[MaxCol] = 0;
+			continue;
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			quantizedBox[i] = (unsigned char)(box[i] >> tileShift);
+		}
+	}
+#elif defined(DICTIONARY_GOAL_BOUNDS)
+	for (int dir = 0; dir < 8; dir++)
+	{
+		const MapCoordinate* box = bounds.bounds[dir];
+
+		if (box[MinRow] > box[MaxRow] || box[MinCol] > box[MaxCol])
+		{
+			goalBounds->boxId[dir] = EmptyGoalBox;
+			continue;
+		}
+
+		// First time this box is seen, it gets the next id
+		std::pair<std::unordered_map<uint64_t, unsigned int>::iterator, bool> entry =
+			m_goalBoxIds.insert(std::make_pair(GetGoalBoxKey(box), (unsigned int)goalBoxes.size()));
+		if (entry.second)
+		{
+			GoalBox newBox = { { box[MinRow], box[MaxRow], box[MinCol], box[MaxCol] } };
+			goalBoxes.push_back(newBox);
+		}
+		goalBounds->boxId[dir] = entry.first->second;
+	}
+#else
+	memcpy(goalBounds->bounds, bounds.bounds, sizeof(bounds.bounds));
+#endif
+
+#ifdef DENSE_NODE_DATA
+	int numOpenDirections = 0;
+	for (int dir = 0; dir < 8; dir++)
 	{
-		t[i] = new T[width];
-		memset(t[i], 0, sizeof(T)*width);
+		if ((record.blockedDirectionBitfield & (1 << dir)) == 0)
+		{
+			memmove(record.bounds[numOpenDirections], record.bounds[dir], sizeof(record.bounds[dir]));
+			numOpenDirections++;
+		}
 	}
+
+	m_nodeDataOffsets[GetCellIndex(r, c, m_cellStride)] = (unsigned int)m_denseNodeData.size();
+	unsigned char* bytes = (unsigned char*)&record;
+	m_denseNodeData.insert(m_denseNodeData.end(), bytes, bytes + GetDenseNodeDataSize(record.blockedDirectionBitfield));
+#endif
 }
 
 template <typename T>
-void PrecomputeMap::DestroyArray(T**& t)
+void PrecomputeMap::InitArray(T*& t, int width, int height)
 {
-	for (int i = 0; i < m_height; ++i)
-		delete[] t[i];
-	delete[] t;
+	// One cache line aligned block per map, indexed by cell
+	t = (T*)AllocateArrayMemory(sizeof(T)*width*height);
+	memset(t, 0, sizeof(T)*width*height);
+}
 
+template <typename T>
+void PrecomputeMap::DestroyArray(T*& t)
+{
+	FreeArrayMemory(t);
 	t = 0;
 }
 
+// Bit c of the result holds column c-1 of the packed row (zero past the left edge)
+static inline uint64_t LeftNeighborBits(const uint64_t* row, int word)
+{
+	uint64_t bits = row[word] << 1;
+	if (word > 0) { bits |= row[word - 1] >> 63; }
+	return bits;
+}
+
+// Bit c of the result holds column c+1 of the packed row (zero past the right edge)
+static inline uint64_t RightNeighborBits(const uint64_t* row, int word, int wordsPerRow)
+{
+	uint64_t bits = row[word] >> 1;
+	if (word + 1 < wordsPerRow) { bits |= row[word + 1] << 63; }
+	return bits;
+}
+
+static inline int LowestSetBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)bits)) { return (int)index; }
+	_BitScanForward(&index, (unsigned long)(bits >> 32));
+	return (int)index + 32;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
 void PrecomputeMap::CalculateJumpPointMap()
 {
+	// The grid is already packed into rows of 64-cell words (a set bit is an empty
+	// cell, bit c + 1 is column c). Its wall border means the rows above and below
+	// the map and the bits outside the columns all read as walls.
+	const int wordsPerRow = m_grid->GetWordsPerRow();
+
+	// A cell is a jump point when its parent is empty and a wall beside the parent
+	// has an empty cell beside this node (a forced neighbor). Test 64 cells at once.
 	for (int r = 0; r < m_height; ++r)
 	{
-		for (int c = 0; c < m_width; ++c)
+		const uint64_t* above = m_grid->GetRow(r - 1);
+		const uint64_t* row = m_grid->GetRow(r);
+		const uint64_t* below = m_grid->GetRow(r + 1);
+
+		for (int word = 0; word < wordsPerRow; ++word)
 		{
-			if (m_map[c + (r * m_width)])
+			uint64_t empty = row[word];
+			if (empty == 0)
 			{
-				if (IsJumpPoint(r, c, 1, 0))
-				{
-					m_jumpPointMap[r][c] |= MovingDown;
-				}
-				if (IsJumpPoint(r, c, -1, 0))
-				{
-					m_jumpPointMap[r][c] |= MovingUp;
-				}
-				if (IsJumpPoint(r, c, 0, 1))
-				{
-					m_jumpPointMap[r][c] |= MovingRight;
-				}
-				if (IsJumpPoint(r, c, 0, -1))
-				{
-					m_jumpPointMap[r][c] |= MovingLeft;
-				}
+				continue;
+			}
+
+			uint64_t left = LeftNeighborBits(row, word);
+			uint64_t right = RightNeighborBits(row, word, wordsPerRow);
+			uint64_t aboveLeft = LeftNeighborBits(above, word);
+			uint64_t aboveRight = RightNeighborBits(above, word, wordsPerRow);
+			uint64_t belowLeft = LeftNeighborBits(below, word);
+			uint64_t belowRight = RightNeighborBits(below, word, wordsPerRow);
+
+			uint64_t movingDown = empty & above[word] & ((right & ~aboveRight) | (left & ~aboveLeft));
+			uint64_t movingUp = empty & below[word] & ((left & ~belowLeft) | (right & ~belowRight));
+			uint64_t movingRight = empty & left & ((below[word] & ~belowLeft) | (above[word] & ~aboveLeft));
+			uint64_t movingLeft = empty & right & ((above[word] & ~aboveRight) | (below[word] & ~belowRight));
+
+			uint64_t jumpPoints = movingDown | movingUp | movingRight | movingLeft;
+			while (jumpPoints != 0)
+			{
+				int bit = LowestSetBit(jumpPoints);
+				jumpPoints &= jumpPoints - 1;
+
+				m_jumpPointMap[r * m_width + (word << 6) + bit - 1] = (unsigned char)(
+					(((movingDown >> bit) & 1) * MovingDown) |
+					(((movingRight >> bit) & 1) * MovingRight) |
+					(((movingUp >> bit) & 1) * MovingUp) |
+					(((movingLeft >> bit) & 1) * MovingLeft));
 			}
 		}
 	}
 }
 
-bool PrecomputeMap::IsJumpPoint(int r, int c, int rowDir, int colDir)
-{
-	return
-		IsEmpty(r - rowDir, c - colDir) &&						// Parent not a wall (not necessary)
-		((IsEmpty(r + colDir, c + rowDir) &&					// 1st forced neighbor
-		IsWall(r - rowDir + colDir, c - colDir + rowDir)) ||	// 1st forced neighbor (continued)
-		((IsEmpty(r - colDir, c - rowDir) &&					// 2nd forced neighbor
-		IsWall(r - rowDir - colDir, c - colDir - rowDir))));	// 2nd forced neighbor (continued)
-}
-
 inline bool PrecomputeMap::IsEmpty(int r, int c)
 {
-	unsigned int colBoundsCheck = c;
-	unsigned int rowBoundsCheck = r;
-	if (colBoundsCheck < (unsigned int)m_width && rowBoundsCheck < (unsigned int)m_height)
-	{
-		return m_map[c + (r * m_width)];
-	}
-	else
-	{
-		return false;
-	}
+	// The grid's wall border makes bounds checks unnecessary one cell outside the map
+	return m_grid->IsEmpty(r, c);
 }
 
 inline bool PrecomputeMap::IsWall(int r, int c)
 {
-	unsigned int colBoundsCheck = c;
-	unsigned int rowBoundsCheck = r;
-	if (colBoundsCheck < (unsigned int)m_width && rowBoundsCheck < (unsigned int)m_height)
-	{
-		return !m_map[c + (r * m_width)];
-	}
-	else
-	{
-		return true;
-	}
+	return m_grid->IsWall(r, c);
 }
 
 void PrecomputeMap::CalculateDistantJumpPointMap()
 {
 	// Calculate distant jump points (Left and Right)
+	// Every row is independent
+	#pragma omp parallel for schedule(dynamic, 16)
 	for (int r = 0; r < m_height; ++r)
 	{
 		{
@@ -353,7 +629,7 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 				{
 					countMovingLeft = -1;
 					jumpPointLastSeen = false;
-					m_distantJumpPointMap[r][c].jumpDistance[Left] = 0;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[Left] = 0;
 					continue;
 				}
 
@@ -361,14 +637,14 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 
 				if (jumpPointLastSeen)
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Left] = countMovingLeft;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[Left] = countMovingLeft;
 				}
 				else // Wall last seen
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Left] = -countMovingLeft;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[Left] = -countMovingLeft;
 				}
 
-				if ((m_jumpPointMap[r][c] & MovingLeft) > 0)
+				if ((m_jumpPointMap[r * m_width + c] & MovingLeft) > 0)
 				{
 					countMovingLeft = 0;
 					jumpPointLastSeen = true;
@@ -385,7 +661,7 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 				{
 					countMovingRight = -1;
 					jumpPointLastSeen = false;
-					m_distantJumpPointMap[r][c].jumpDistance[Right] = 0;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[Right] = 0;
 					continue;
 				}
 
@@ -393,14 +669,14 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 
 				if (jumpPointLastSeen)
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Right] = countMovingRight;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[Right] = countMovingRight;
 				}
 				else // Wall last seen
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Right] = -countMovingRight;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[Right] = -countMovingRight;
 				}
 
-				if ((m_jumpPointMap[r][c] & MovingRight) > 0)
+				if ((m_jumpPointMap[r * m_width + c] & MovingRight) > 0)
 				{
 					countMovingRight = 0;
 					jumpPointLastSeen = true;
@@ -410,76 +686,112 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 	}
 
 	// Calculate distant jump points (Up and Down)
-	for (int c = 0; c < m_width; ++c)
+	// Each column is an independent scan, but walking down a column touches a new
+	// row on every step. Instead, sweep whole rows and keep one counter per column,
+	// so memory is read in row order and the columns of a block can be processed together.
+	const int columnBlockWidth = 256;
+	const int numColumnBlocks = (m_width + columnBlockWidth - 1) / columnBlockWidth;
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int block = 0; block < numColumnBlocks; ++block)
 	{
+		int firstCol = block * columnBlockWidth;
+		int lastCol = firstCol + columnBlockWidth;
+		if (lastCol > m_width) { lastCol = m_width; }
+
+		int countMovingUp[columnBlockWidth];
+		int countMovingDown[columnBlockWidth];
+		bool jumpPointLastSeenUp[columnBlockWidth];
+		bool jumpPointLastSeenDown[columnBlockWidth];
+
+		for (int c = firstCol; c < lastCol; ++c)
 		{
-			int countMovingUp = -1;
-			bool jumpPointLastSeen = false;
-			for (int r = 0; r < m_height; ++r)
+			countMovingUp[c - firstCol] = -1;
+			countMovingDown[c - firstCol] = -1;
+			jumpPointLastSeenUp[c - firstCol] = false;
+			jumpPointLastSeenDown[c - firstCol] = false;
+		}
+
+		for (int r = 0; r < m_height; ++r)
+		{
+			DistantJumpPoints* distantJumpPoints = &m_distantJumpPointMap[r * m_width];
+			unsigned char* jumpPoints = &m_jumpPointMap[r * m_width];
+
+			for (int c = firstCol; c < lastCol; ++c)
 			{
+				int i = c - firstCol;
+
 				if (IsWall(r, c))
 				{
-					countMovingUp = -1;
-					jumpPointLastSeen = false;
-					m_distantJumpPointMap[r][c].jumpDistance[Up] = 0;
+					countMovingUp[i] = -1;
+					jumpPointLastSeenUp[i] = false;
+					distantJumpPoints[c].jumpDistance[Up] = 0;
 					continue;
 				}
 
-				countMovingUp++;
+				countMovingUp[i]++;
 
-				if (jumpPointLastSeen)
+				if (jumpPointLastSeenUp[i])
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Up] = countMovingUp;
+					distantJumpPoints[c].jumpDistance[Up] = countMovingUp[i];
 				}
 				else // Wall last seen
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Up] = -countMovingUp;
+					distantJumpPoints[c].jumpDistance[Up] = -countMovingUp[i];
 				}
 
-				if ((m_jumpPointMap[r][c] & MovingUp) > 0)
+				if ((jumpPoints[c] & MovingUp) > 0)
 				{
-					countMovingUp = 0;
-					jumpPointLastSeen = true;
+					countMovingUp[i] = 0;
+					jumpPointLastSeenUp[i] = true;
 				}
 			}
 		}
 
+		for (int r = m_height - 1; r >= 0; --r)
 		{
-			int countMovingDown = -1;
-			bool jumpPointLastSeen = false;
-			for (int r = m_height - 1; r >= 0; --r)
+			DistantJumpPoints* distantJumpPoints = &m_distantJumpPointMap[r * m_width];
+			unsigned char* jumpPoints = &m_jumpPointMap[r * m_width];
+
+			for (int c = firstCol; c < lastCol; ++c)
 			{
+				int i = c - firstCol;
+
 				if (IsWall(r, c))
 				{
-					countMovingDown = -1;
-					jumpPointLastSeen = false;
-					m_distantJumpPointMap[r][c].jumpDistance[Down] = 0;
+					countMovingDown[i] = -1;
+					jumpPointLastSeenDown[i] = false;
+					distantJumpPoints[c].jumpDistance[Down] = 0;
 					continue;
 				}
 
-				countMovingDown++;
+				countMovingDown[i]++;
 
-				if (jumpPointLastSeen)
+				if (jumpPointLastSeenDown[i])
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Down] = countMovingDown;
+					distantJumpPoints[c].jumpDistance[Down] = countMovingDown[i];
 				}
 				else // Wall last seen
 				{
-					m_distantJumpPointMap[r][c].jumpDistance[Down] = -countMovingDown;
+					distantJumpPoints[c].jumpDistance[Down] = -countMovingDown[i];
 				}
 
-				if ((m_jumpPointMap[r][c] & MovingDown) > 0)
+				if ((jumpPoints[c] & MovingDown) > 0)
 				{
-					countMovingDown = 0;
-					jumpPointLastSeen = true;
+					countMovingDown[i] = 0;
+					jumpPointLastSeenDown[i] = true;
 				}
 			}
 		}
 	}
 
 	// Calculate distant jump points (Diagonally UpLeft and UpRight)
+	// Each row only depends on the row above it, so the cells of a row are split across
+	// threads and the threads meet at the end of every row (implicit barrier of "omp for").
+	#pragma omp parallel
 	for (int r = 0; r < m_height; ++r)
 	{
+		#pragma omp for schedule(static)
 		for (int c = 0; c < m_width; ++c)
 		{
 			if (IsEmpty(r, c))
@@ -487,27 +799,27 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 				if (r == 0 || c == 0 || (IsWall(r - 1, c) || IsWall(r, c - 1) || IsWall(r - 1, c - 1)))
 				{
 					// Wall one away
-					m_distantJumpPointMap[r][c].jumpDistance[UpLeft] = 0;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[UpLeft] = 0;
 				}
 				else if (IsEmpty(r - 1, c) && IsEmpty(r, c - 1) && 
-					(m_distantJumpPointMap[r - 1][c - 1].jumpDistance[Up] > 0 ||
-					 m_distantJumpPointMap[r - 1][c - 1].jumpDistance[Left] > 0))
+					(m_distantJumpPointMap[(r - 1) * m_width + c - 1].jumpDistance[Up] > 0 ||
+					 m_distantJumpPointMap[(r - 1) * m_width + c - 1].jumpDistance[Left] > 0))
 				{
 					// Diagonal one away
-					m_distantJumpPointMap[r][c].jumpDistance[UpLeft] = 1;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[UpLeft] = 1;
 				}
 				else
 				{
 					// Increment from last
-					int jumpDistance = m_distantJumpPointMap[r - 1][c - 1].jumpDistance[UpLeft];
+					int jumpDistance = m_distantJumpPointMap[(r - 1) * m_width + c - 1].jumpDistance[UpLeft];
 
 					if (jumpDistance > 0)
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[UpLeft] = 1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[UpLeft] = 1 + jumpDistance;
 					}
 					else //if( jumpDistance <= 0 )
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[UpLeft] = -1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[UpLeft] = -1 + jumpDistance;
 					}
 				}
 
@@ -515,27 +827,27 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 				if (r == 0 || c == m_width - 1 || (IsWall(r - 1, c) || IsWall(r, c + 1) || IsWall(r - 1, c + 1)))
 				{
 					// Wall one away
-					m_distantJumpPointMap[r][c].jumpDistance[UpRight] = 0;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[UpRight] = 0;
 				}
 				else if (IsEmpty(r - 1, c) && IsEmpty(r, c + 1) &&
-					(m_distantJumpPointMap[r - 1][c + 1].jumpDistance[Up] > 0 ||
-					 m_distantJumpPointMap[r - 1][c + 1].jumpDistance[Right] > 0))
+					(m_distantJumpPointMap[(r - 1) * m_width + c + 1].jumpDistance[Up] > 0 ||
+					 m_distantJumpPointMap[(r - 1) * m_width + c + 1].jumpDistance[Right] > 0))
 				{
 					// Diagonal one away
-					m_distantJumpPointMap[r][c].jumpDistance[UpRight] = 1;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[UpRight] = 1;
 				}
 				else
 				{
 					// Increment from last
-					int jumpDistance = m_distantJumpPointMap[r - 1][c + 1].jumpDistance[UpRight];
+					int jumpDistance = m_distantJumpPointMap[(r - 1) * m_width + c + 1].jumpDistance[UpRight];
 
 					if (jumpDistance > 0)
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[UpRight] = 1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[UpRight] = 1 + jumpDistance;
 					}
 					else //if( jumpDistance <= 0 )
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[UpRight] = -1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[UpRight] = -1 + jumpDistance;
 					}
 				}
 			}
@@ -543,8 +855,11 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 	}
 
 	// Calculate distant jump points (Diagonally DownLeft and DownRight)
+	// Each row only depends on the row below it
+	#pragma omp parallel
 	for (int r = m_height - 1; r >= 0; --r)
 	{
+		#pragma omp for schedule(static)
 		for (int c = 0; c < m_width; ++c)
 		{
 			if (IsEmpty(r, c))
@@ -553,27 +868,27 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 					(IsWall(r + 1, c) || IsWall(r, c - 1) || IsWall(r + 1, c - 1)))
 				{
 					// Wall one away
-					m_distantJumpPointMap[r][c].jumpDistance[DownLeft] = 0;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[DownLeft] = 0;
 				}
 				else if (IsEmpty(r + 1, c) && IsEmpty(r, c - 1) &&
-					(m_distantJumpPointMap[r + 1][c - 1].jumpDistance[Down] > 0 ||
-					 m_distantJumpPointMap[r + 1][c - 1].jumpDistance[Left] > 0))
+					(m_distantJumpPointMap[(r + 1) * m_width + c - 1].jumpDistance[Down] > 0 ||
+					 m_distantJumpPointMap[(r + 1) * m_width + c - 1].jumpDistance[Left] > 0))
 				{
 					// Diagonal one away
-					m_distantJumpPointMap[r][c].jumpDistance[DownLeft] = 1;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[DownLeft] = 1;
 				}
 				else
 				{
 					// Increment from last
-					int jumpDistance = m_distantJumpPointMap[r + 1][c - 1].jumpDistance[DownLeft];
+					int jumpDistance = m_distantJumpPointMap[(r + 1) * m_width + c - 1].jumpDistance[DownLeft];
 
 					if (jumpDistance > 0)
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[DownLeft] = 1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[DownLeft] = 1 + jumpDistance;
 					}
 					else //if( jumpDistance <= 0 )
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[DownLeft] = -1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[DownLeft] = -1 + jumpDistance;
 					}
 				}
 
@@ -581,27 +896,27 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 				if (r == m_height - 1 || c == m_width - 1 || (IsWall(r + 1, c) || IsWall(r, c + 1) || IsWall(r + 1, c + 1)))
 				{
 					// Wall one away
-					m_distantJumpPointMap[r][c].jumpDistance[DownRight] = 0;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[DownRight] = 0;
 				}
 				else if (IsEmpty(r + 1, c) && IsEmpty(r, c + 1) &&
-					(m_distantJumpPointMap[r + 1][c + 1].jumpDistance[Down] > 0 ||
-					 m_distantJumpPointMap[r + 1][c + 1].jumpDistance[Right] > 0))
+					(m_distantJumpPointMap[(r + 1) * m_width + c + 1].jumpDistance[Down] > 0 ||
+					 m_distantJumpPointMap[(r + 1) * m_width + c + 1].jumpDistance[Right] > 0))
 				{
 					// Diagonal one away
-					m_distantJumpPointMap[r][c].jumpDistance[DownRight] = 1;
+					m_distantJumpPointMap[r * m_width + c].jumpDistance[DownRight] = 1;
 				}
 				else
 				{
 					// Increment from last
-					int jumpDistance = m_distantJumpPointMap[r + 1][c + 1].jumpDistance[DownRight];
+					int jumpDistance = m_distantJumpPointMap[(r + 1) * m_width + c + 1].jumpDistance[DownRight];
 
 					if (jumpDistance > 0)
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[DownRight] = 1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[DownRight] = 1 + jumpDistance;
 					}
 					else //if( jumpDistance <= 0 )
 					{
-						m_distantJumpPointMap[r][c].jumpDistance[DownRight] = -1 + jumpDistance;
+						m_distantJumpPointMap[r * m_width + c].jumpDistance[DownRight] = -1 + jumpDistance;
 					}
 				}
 			}
@@ -609,83 +924,233 @@ void PrecomputeMap::CalculateDistantJumpPointMap()
 	}
 }
 
-void PrecomputeMap::CalculateGoalBounding()
+void PrecomputeMap::CalculateGoalBounding(const char *filename, const BitGrid* oldGrid, const char *oldFilename)
 {
 	printf("Goal Bounding Preprocessing\n");
 
-	DijkstraFloodfill* dijkstra = new DijkstraFloodfill(m_width, m_height, m_map, m_distantJumpPointMap);
+#ifdef FILE_FORMAT_ASCII
+	ofstream file(filename);
+#else
+	ofstream file(filename, std::ios::out | std::ios::binary);
+#endif
 
-	InitArray(m_goalBoundsMap, m_width, m_height);
-	for (int r = 0; r < m_height; ++r)
+	// Incremental rebuild: a flood only reads the blocked directions of the cells it reaches,
+	// which depend on the cell and its 8 neighbors. Every reached cell lies inside one of
+	// the start's goal bounds, so if no changed cell (or neighbor of one) is inside the old
+	// bounds, and the start isn't one of them, the flood would be identical and is reused.
+	std::vector<int> dirtyRows, dirtyCols;
+	std::vector<std::streamoff> oldRowOffsets;
+	if (oldGrid != 0)
 	{
-		for (int c = 0; c < m_width; ++c)
+		for (int r = 0; r < m_height; ++r)
 		{
-			for (int dir = 0; dir < 8; ++dir)
+			for (int c = 0; c < m_width; ++c)
 			{
-				m_goalBoundsMap[r][c].bounds[dir][MinRow] = m_height;
-				m_goalBoundsMap[r][c].bounds[dir][MaxRow] = 0;
-				m_goalBoundsMap[r][c].bounds[dir][MinCol] = m_width;
-				m_goalBoundsMap[r][c].bounds[dir][MaxCol] = 0;
+				bool dirty = false;
+				for (int offsetRow = -1; offsetRow <= 1 && !dirty; ++offsetRow)
+				{
+					for (int offsetCol = -1; offsetCol <= 1 && !dirty; ++offsetCol)
+					{
+						dirty = oldGrid->IsEmpty(r + offsetRow, c + offsetCol) != m_grid->IsEmpty(r + offsetRow, c + offsetCol);
+					}
+				}
+
+				if (dirty)
+				{
+					dirtyRows.push_back(r);
+					dirtyCols.push_back(c);
+				}
 			}
 		}
+
+		// Rows of the old file have varying sizes, so find where each one starts
+#ifdef FILE_FORMAT_ASCII
+		ifstream oldFile(oldFilename);
+#else
+		ifstream oldFile(oldFilename, std::ios::in | std::ios::binary);
+#endif
+		GoalBounds* oldRowBounds = new GoalBounds[m_width];
+		bool oldFileValid = oldFile.is_open();
+		for (int r = 0; r < m_height && oldFileValid; ++r)
+		{
+			oldRowOffsets.push_back(oldFile.tellg());
+			LoadRow(oldFile, r, oldGrid, oldRowBounds);
+			oldFileValid = !oldFile.fail();
+		}
+		delete[] oldRowBounds;
+
+		// The old file must end right after its last row, otherwise it wasn't made for the old grid
+#ifdef FILE_FORMAT_ASCII
+		oldFile >> std::ws;
+#endif
+		if (!oldFileValid || oldFile.peek() != std::char_traits<char>::eof())
+		{
+			printf("Can't reuse '%s' (missing or not made for the old map), rebuilding everything\n", oldFilename);
+			oldGrid = 0;
+			dirtyRows.clear();
+			dirtyCols.clear();
+			oldRowOffsets.clear();
+		}
 	}
+	int numFloods = 0;
+
+	// The goal bounds are never held for the whole map. A row is saved as soon as it is done.
+	// Rows can finish out of order when run in parallel, so a finished row waits here
+	// until every row above it has been written (only a few rows wait at any time).
+	std::vector<std::string*> finishedRows(m_height, (std::string*)0);
+	int nextRowToWrite = 0;
 
-	for (int startRow = 0; startRow < m_height; ++startRow)
+	// Each flood only writes the bounds of its own start cell, so the floods are independent.
+	// Every thread owns one floodfill (its node arrays are now small enough to replicate).
+	#pragma omp parallel
 	{
-		printf("Row: %d\n", startRow);
+		DijkstraFloodfill* dijkstra = new DijkstraFloodfill(m_grid, m_distantJumpPointMap);
+		GoalBounds* rowBounds = new GoalBounds[m_width];
+
+		// Every thread reads the old file on its own
+		ifstream* oldFile = 0;
+		GoalBounds* oldRowBounds = 0;
+		if (oldGrid != 0)
+		{
+#ifdef FILE_FORMAT_ASCII
+			oldFile = new ifstream(oldFilename);
+#else
+			oldFile = new ifstream(oldFilename, std::ios::in | std::ios::binary);
+#endif
+			oldRowBounds = new GoalBounds[m_width];
+		}
 
-		for (int startCol = 0; startCol < m_width; ++startCol)
+		#pragma omp for schedule(dynamic) reduction(+:numFloods)
+		for (int startRow = 0; startRow < m_height; ++startRow)
 		{
-			if (IsWall(startRow, startCol))
+			printf("Row: %d\n", startRow);
+
+			// Reuse only bounds that were actually read back
+			bool reuseOldRow = false;
+			if (oldFile != 0)
 			{
-				continue;
+				oldFile->clear();
+				oldFile->seekg(oldRowOffsets[startRow]);
+				LoadRow(*oldFile, startRow, oldGrid, oldRowBounds);
+				reuseOldRow = !oldFile->fail();
 			}
 
-			dijkstra->Flood(startRow, startCol);
-			int currentIteration = dijkstra->GetCurrentInteration();
-
-			for (int r = 0; r < m_height; ++r)
+			for (int startCol = 0; startCol < m_width; ++startCol)
 			{
-				for (int c = 0; c < m_width; ++c)
+				GoalBounds& goalBounds = rowBounds[startCol];
+				for (int dir = 0; dir < 8; ++dir)
 				{
-					if (IsWall(r, c))
-					{
-						continue;
-					}
+					goalBounds.bounds[dir][MinRow] = m_height;
+					goalBounds.bounds[dir][MaxRow] = 0;
+					goalBounds.bounds[dir][MinCol] = m_width;
+					goalBounds.bounds[dir][MaxCol] = 0;
+				}
 
-					int iteration = dijkstra->m_mapNodes[r][c].m_iteration;
-					unsigned char status = dijkstra->m_mapNodes[r][c].m_listStatus;
-					int dir = dijkstra->m_mapNodes[r][c].m_directionFromStart;
+				if (IsWall(startRow, startCol))
+				{
+					continue;
+				}
 
-					if (iteration == currentIteration && 
-						status == PathfindingNode::OnClosed &&
-						dir >= 0 && dir <= 7)
-					{
-						int row = dijkstra->m_mapNodes[r][c].m_row;
-						int col = dijkstra->m_mapNodes[r][c].m_col;
+				if (reuseOldRow && !CanSeeDirtyCells(startRow, startCol, oldRowBounds[startCol], dirtyRows, dirtyCols))
+				{
+					goalBounds = oldRowBounds[startCol];
+					continue;
+				}
 
-						if (m_goalBoundsMap[startRow][startCol].bounds[dir][MinRow] > row)
-						{ 
-							m_goalBoundsMap[startRow][startCol].bounds[dir][MinRow] = row; 
-						}
-						if (m_goalBoundsMap[startRow][startCol].bounds[dir][MaxRow] < row)
-						{ 
-							m_goalBoundsMap[startRow][startCol].bounds[dir][MaxRow] = row; 
+				dijkstra->Flood(startRow, startCol);
+				numFloods++;
+
+				for (int r = 0; r < m_height; ++r)
+				{
+					for (int c = 0; c < m_width; ++c)
+					{
+						if (IsWall(r, c))
+						{
+							continue;
 						}
-						if (m_goalBoundsMap[startRow][startCol].bounds[dir][MinCol] > col)
-						{ 
-							m_goalBoundsMap[startRow][startCol].bounds[dir][MinCol] = col; 
+
+						unsigned int node = c + (r * m_width);
+						if (!dijkstra->IsClosed(node))
+						{
+							continue;
 						}
-						if (m_goalBoundsMap[startRow][startCol].bounds[dir][MaxCol] < col)
-						{ 
-							m_goalBoundsMap[startRow][startCol].bounds[dir][MaxCol] = col; 
+
+						int dir = dijkstra->GetDirectionFromStart(node);
+						if (dir <= 7)
+						{
+							if (goalBounds.bounds[dir][MinRow] > r)
+							{ 
+								goalBounds.bounds[dir][MinRow] = r; 
+							}
+							if (goalBounds.bounds[dir][MaxRow] < r)
+							{ 
+								goalBounds.bounds[dir][MaxRow] = r; 
+							}
+							if (goalBounds.bounds[dir][MinCol] > c)
+							{ 
+								goalBounds.bounds[dir][MinCol] = c; 
+							}
+							if (goalBounds.bounds[dir][MaxCol] < c)
+							{ 
+								goalBounds.bounds[dir][MaxCol] = c; 
+							}
 						}
 					}
 				}
 			}
+
+			std::ostringstream rowRecord;
+			SaveRow(rowRecord, startRow, rowBounds);
+			std::string* record = new std::string(rowRecord.str());
+
+			#pragma omp critical(GoalBoundsFile)
+			{
+				finishedRows[startRow] = record;
+				while (nextRowToWrite < m_height && finishedRows[nextRowToWrite] != 0)
+				{
+					file.write(finishedRows[nextRowToWrite]->data(), finishedRows[nextRowToWrite]->size());
+					delete finishedRows[nextRowToWrite];
+					finishedRows[nextRowToWrite] = 0;
+					++nextRowToWrite;
+				}
+			}
 		}
+
+		delete[] rowBounds;
+		delete dijkstra;
+		delete[] oldRowBounds;
+		delete oldFile;
 	}
 
-	delete dijkstra;
+	m_stats.numFloods = numFloods;
+	if (oldGrid != 0)
+	{
+		printf("Flooded %d start cells, the others were reused\n", numFloods);
+	}
 }
 
+bool PrecomputeMap::CanSeeDirtyCells(int startRow, int startCol, const GoalBounds& oldBounds,
+	const std::vector<int>& dirtyRows, const std::vector<int>& dirtyCols)
+{
+	for (unsigned int i = 0; i < dirtyRows.size(); ++i)
+	{
+		int r = dirtyRows[i];
+		int c = dirtyCols[i];
+
+		if (r == startRow && c == startCol)
+		{
+			return true;
+		}
+
+		for (int dir = 0; dir < 8; ++dir)
+		{
+			if (r >= oldBounds.bounds[dir][MinRow] && r <= oldBounds.bounds[dir][MaxRow] &&
+				c >= oldBounds.bounds[dir][MinCol] && c <= oldBounds.bounds[dir][MaxCol])
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
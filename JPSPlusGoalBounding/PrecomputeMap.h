@@ -39,6 +39,13 @@
 
 #pragma once
 #include <vector>
+#include <ostream>
+#include <istream>
+#include <unordered_map>
+#include <stdint.h>
+#include <stddef.h>
+#include "BitGrid.h"
+#include "MapTypes.h"
 
 enum ArrayDirections
 {
@@ -63,50 +70,307 @@ enum GoalBoundsEnum
 
 struct DistantJumpPoints
 {
-	short jumpDistance[8];
+	MapCoordinate jumpDistance[8];
 };
 
 struct GoalBounds
 {
-	short bounds[8][4];
+	MapCoordinate bounds[8][4];
 };
 
+// The goal bounds of a single direction
+struct GoalBox
+{
+	MapCoordinate bounds[4];
+};
+
+//#define SPLIT_HOT_COLD_NODE_DATA	// Jump distances and goal bounds in two separate arrays (slower, see below)
+//#define DENSE_NODE_DATA			// Records only for open cells, with goal bounds only for open directions (see below)
+//#define SUCCESSOR_CELL_INDICES	// Cell index of each direction's jump point next to its jump distance (see below)
+#define TILED_NODE_LAYOUT				// Records and search nodes in 8x8 cell tiles instead of rows (see below)
+#define SPECIALIZED_CELL_STRIDES		// Widths just under a power of two padded to it, with a search compiled for that stride (see below)
+#define COMPRESSED_GOAL_BOUNDS		// Goal bounds as 8-bit offsets from the node (half the size, same pruning)
+//#define QUANTIZED_GOAL_BOUNDS		// Goal bounds as 8-bit tiles rounded outward (half the size, no side table, more expansions on large maps)
+//#define DICTIONARY_GOAL_BOUNDS		// Goal bounds as ids into a table of distinct boxes (exact, smaller on structured maps)
+
+#if defined(COMPRESSED_GOAL_BOUNDS) + defined(QUANTIZED_GOAL_BOUNDS) + defined(DICTIONARY_GOAL_BOUNDS) > 1
+#error Only one goal bounds encoding can be used
+#endif
+
+#ifdef COMPRESSED_GOAL_BOUNDS
+// Goal bounds relative to the node's own row/col. Offsets in [-127, 126] are exact. Further ones
+// are saturated to -128/127 and the direction's bit is set in farBoundsBitfield. With the goal's
+// offset saturated the same way, a saturated bound only gives the wrong answer when the goal is
+// itself at least 127 rows or columns away, and only then does the search confirm against the
+// absolute box in a side table. Empty boxes are [127, -128], which nothing passes.
+// Only the far boxes go to the side table, consecutively in direction order.
+struct RelativeGoalBounds
+{
+	signed char bounds[8][4];
+	unsigned char farBoundsBitfield;	// highest bit [DownLeft, Left, UpLeft, Up, UpRight, Right, DownRight, Down] lowest bit
+	int farBoundsIndex;					// Side table index of the first far box
+};
+
+inline int SaturateGoalBoundsOffset(int offset)
+{
+	return offset < -128 ? -128 : (offset > 127 ? 127 : offset);
+}
+
+typedef RelativeGoalBounds EncodedGoalBounds;
+typedef signed char GoalBoundsValue;
+#elif defined(QUANTIZED_GOAL_BOUNDS)
+// Goal bounds in square tiles of (1 << tileShift) cells. The minimum is rounded down and the
+// maximum is compared against the goal's tile, so boxes only ever grow and paths stay optimal.
+// Empty boxes are [255, 0], which nothing passes.
+struct QuantizedGoalBounds
+{
+	unsigned char bounds[8][4];
+};
+
+// Smallest tile that keeps every row and column below 255 tiles (boxes cost the same at any
+// tile size, so larger tiles would only add expansions). Maps up to 255 cells are exact.
+inline int GetGoalBoundsTileShift(int width, int height)
+{
+	int largest = (width > height ? width : height) - 1;
+	int tileShift = 0;
+	while ((largest >> tileShift) >= 255)
+	{
+		tileShift++;
+	}
+	return tileShift;
+}
+
+typedef QuantizedGoalBounds EncodedGoalBounds;
+typedef unsigned char GoalBoundsValue;
+#elif defined(DICTIONARY_GOAL_BOUNDS)
+// Each direction's box is an id into a side table holding every distinct box once. Neighboring
+// cells along corridors and inside rooms often share boxes. Ids are 32 bits, since larger maps
+// have more distinct boxes than 16 bits can count (300k on a random 400x400). The first two
+// ids are reserved for the empty box and the whole map box, which are the most common.
+struct GoalBoxIds
+{
+	unsigned int boxId[8];
+};
+
+enum ReservedGoalBoxIds
+{
+	EmptyGoalBox			= 0,
+	WholeMapGoalBox			= 1,
+	NumReservedGoalBoxes	= 2
+};
+
+// Bounds are never above 65535, even in the large map mode, so 16 bits of each is the whole box
+inline uint64_t GetGoalBoxKey(const MapCoordinate* box)
+{
+	return (uint64_t)(unsigned short)box[MinRow] | ((uint64_t)(unsigned short)box[MaxRow] << 16) |
+		((uint64_t)(unsigned short)box[MinCol] << 32) | ((uint64_t)(unsigned short)box[MaxCol] << 48);
+}
+
+typedef GoalBoxIds EncodedGoalBounds;
+#else
+typedef GoalBounds EncodedGoalBounds;
+typedef MapCoordinate GoalBoundsValue;
+#endif
+
+// Per-node data read by the search. By default it is one interleaved record per node. The split
+// layout keeps the bitfield and jump distances (read on every expansion) densely packed in one
+// array and the goal bounds in another. Measured with a cache model, the split costs more misses
+// per expansion, since every expansion also reads the goal bounds of the directions it explores.
+// The dense layout has one variable-length record per open cell, found through a table of
+// offsets. Walls get no record and a record only holds the goal bounds of its open directions,
+// in direction order (blocked directions are never explored and their bounds are empty).
+// With successor cell indices, every record also holds the cell index of the jump point (or
+// wall stop) in each direction, so a jump is one load rather than rebuilding row and col. The
+// sign of the jump distance still tells them apart, and the goal targeting still uses it.
+#if defined(DENSE_NODE_DATA) && (defined(SPLIT_HOT_COLD_NODE_DATA) || defined(DICTIONARY_GOAL_BOUNDS))
+#error The dense layout cannot be split and needs the goal bounds inside the record
+#endif
+
+// Cell index of a record (and of a search node). By default cells are row-major. The tiled
+// layout stores square tiles of 8x8 cells one after the other, row-major within the tile and
+// the tiles row-major, so vertical and diagonal neighbors share a node's pages instead of being
+// a whole row apart (a tile of 64-byte records is one 4 KB page). Arrays are padded to whole tiles.
+#ifdef TILED_NODE_LAYOUT
+enum { CellTileShift = 3, CellTileMask = (1 << CellTileShift) - 1 };
+
+inline int GetCellLayoutWidth(int width) { return (width + CellTileMask) & ~CellTileMask; }
+inline int GetCellLayoutHeight(int height) { return (height + CellTileMask) & ~CellTileMask; }
+
+inline unsigned int GetCellIndex(int r, int c, int width)
+{
+	// Tiles before this one (times 64) plus the position within the tile
+	return ((((r >> CellTileShift) * GetCellLayoutWidth(width) + (c & ~CellTileMask)) << CellTileShift) |
+		((r & CellTileMask) << CellTileShift) | (c & CellTileMask));
+}
+
+inline int GetCellRow(unsigned int index, int width)
+{
+	int tilesPerRow = GetCellLayoutWidth(width) >> CellTileShift;
+	return (((index >> (2 * CellTileShift)) / tilesPerRow) << CellTileShift) | ((index >> CellTileShift) & CellTileMask);
+}
+
+inline int GetCellCol(unsigned int index, int width)
+{
+	int tilesPerRow = GetCellLayoutWidth(width) >> CellTileShift;
+	return (((index >> (2 * CellTileShift)) % tilesPerRow) << CellTileShift) | (index & CellTileMask);
+}
+#else
+inline int GetCellLayoutWidth(int width) { return width; }
+inline int GetCellLayoutHeight(int height) { return height; }
+inline unsigned int GetCellIndex(int r, int c, int width) { return r * width + c; }
+inline int GetCellRow(unsigned int index, int width) { return index / width; }
+inline int GetCellCol(unsigned int index, int width) { return index % width; }
+#endif
+
+// Row stride of the cell index. With specialized strides, a width within a quarter of a power
+// of two from 64 to 4096 is padded up to it, and the search is instantiated for that stride (see
+// CreateJPSPlus), so its index math above is shifts and masks instead of multiplies and divides.
+// Other widths keep their own stride and the generic search. The helpers above take the stride
+// as their width, padding it again is a no-op.
+enum { MinCellStrideShift = 6, MaxCellStrideShift = 12 };
+
+inline int GetCellStrideShift(int width)
+{
+#ifdef SPECIALIZED_CELL_STRIDES
+	for (int shift = MinCellStrideShift; shift <= MaxCellStrideShift; shift++)
+	{
+		if (width <= (1 << shift))
+		{
+			return width * 4 >= (3 << shift) ? shift : 0;
+		}
+	}
+#endif
+	return 0;
+}
+
+inline int GetCellStride(int width)
+{
+	int shift = GetCellStrideShift(width);
+	return shift != 0 ? 1 << shift : width;
+}
+
+#ifdef SPLIT_HOT_COLD_NODE_DATA
+struct JumpDistances
+{
+	MapCoordinate jumpDistance[8];
+	unsigned char blockedDirectionBitfield;	// highest bit [DownLeft, Left, UpLeft, Up, UpRight, Right, DownRight, Down] lowest bit
+#ifdef SUCCESSOR_CELL_INDICES
+	unsigned int jumpPointIndex[8];		// GetCellIndex at the jump distance
+#endif
+};
+
+typedef JumpDistances NodeJumpDistances;
+typedef EncodedGoalBounds NodeGoalBounds;
+#elif defined(DENSE_NODE_DATA)
+struct DenseNodeData
+{
+	unsigned char blockedDirectionBitfield;	// highest bit [DownLeft, Left, UpLeft, Up, UpRight, Right, DownRight, Down] lowest bit
+	MapCoordinate jumpDistance[8];
+#ifdef SUCCESSOR_CELL_INDICES
+	unsigned int jumpPointIndex[8];		// GetCellIndex at the jump distance
+#endif
+#ifdef COMPRESSED_GOAL_BOUNDS
+	unsigned char farBoundsBitfield;	// See RelativeGoalBounds
+	int farBoundsIndex;
+#endif
+	GoalBoundsValue bounds[8][4];		// Only the open directions are stored, see GetDenseNodeDataSize
+};
+
+// Bytes taken by a record, up to the next record's alignment
+inline int GetDenseNodeDataSize(unsigned char blockedDirectionBitfield)
+{
+	int numOpenDirections = 0;
+	for (int dir = 0; dir < 8; dir++)
+	{
+		if ((blockedDirectionBitfield & (1 << dir)) == 0)
+		{
+			numOpenDirections++;
+		}
+	}
+
+	const int alignment = __alignof(DenseNodeData);
+	int size = (int)offsetof(DenseNodeData, bounds) + numOpenDirections * 4 * (int)sizeof(GoalBoundsValue);
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+typedef DenseNodeData NodeJumpDistances;
+typedef DenseNodeData NodeGoalBounds;
+#else
+typedef EncodedGoalBounds NodeGoalBounds;
+
 struct JumpDistancesAndGoalBounds
 {
 	unsigned char blockedDirectionBitfield;	// highest bit [DownLeft, Left, UpLeft, Up, UpRight, Right, DownRight, Down] lowest bit
-	short jumpDistance[8];
-	short bounds[8][4];
+	MapCoordinate jumpDistance[8];
+	NodeGoalBounds goalBounds;
+#ifdef SUCCESSOR_CELL_INDICES
+	unsigned int jumpPointIndex[8];		// GetCellIndex at the jump distance
+#endif
+#if defined(COMPRESSED_GOAL_BOUNDS) && !defined(SUCCESSOR_CELL_INDICES) && !defined(LARGE_MAP_MODE)
+	unsigned char padding[4];	// 64 bytes, so each record is exactly one cache line
+#endif
+};
+
+typedef JumpDistancesAndGoalBounds NodeJumpDistances;
+#endif
+
+// Timings of the last CalculateMap, for benchmarking the preprocessing
+struct PrecomputeStats
+{
+	double jumpPointSeconds;
+	double distantJumpPointSeconds;
+	double goalBoundingSeconds;
+	int numFloods;
 };
 
 class PrecomputeMap
 {
 public:
-	PrecomputeMap(int width, int height, std::vector<bool> map);
+	PrecomputeMap(const BitGrid* grid);
 	~PrecomputeMap();
 
-	DistantJumpPoints** CalculateMap();
-	void SaveMap(const char *filename);
+	void CalculateMap(const char *filename);
+	void CalculateMapIncremental(const BitGrid* oldGrid, const char *oldFilename, const char *filename);
 	void LoadMap(const char *filename);
-	JumpDistancesAndGoalBounds** GetPreprocessedMap() { return m_jumpDistancesAndGoalBoundsMap; }
-	void ReleaseMap() { if (m_mapCreated) DestroyArray(m_distantJumpPointMap); }
+	NodeJumpDistances* GetJumpDistancesMap() { return m_jumpDistancesMap; }
+	NodeGoalBounds* GetGoalBoundsMap() { return m_goalBoundsMap; }	// Only when split, otherwise inside the jump distances
+	GoalBox* GetGoalBoxes() { return m_goalBoxes; }		// Only when compressed or dictionary encoded
+	unsigned int* GetNodeDataOffsets() { return m_nodeDataOffsets; }	// Only when dense, byte offset of each open cell's record
+	const PrecomputeStats& GetStats() { return m_stats; }
+	void ReleaseMap();
 
 protected:
 	bool m_mapCreated;
 	int m_width;
 	int m_height;
-	std::vector<bool> m_map;
-	unsigned char** m_jumpPointMap;
-	DistantJumpPoints** m_distantJumpPointMap;
-	GoalBounds** m_goalBoundsMap;
-	JumpDistancesAndGoalBounds** m_jumpDistancesAndGoalBoundsMap;
+	int m_cellStride;	// Of the search arrays (see GetCellStride)
+	const BitGrid* m_grid;
+	// Maps are single allocations indexed by (row * width + col), the search ones by GetCellIndex
+	unsigned char* m_jumpPointMap;
+	DistantJumpPoints* m_distantJumpPointMap;
+	NodeJumpDistances* m_jumpDistancesMap;
+	NodeGoalBounds* m_goalBoundsMap;
+	GoalBox* m_goalBoxes;
+	unsigned int* m_nodeDataOffsets;
+#ifdef DENSE_NODE_DATA
+	std::vector<unsigned char> m_denseNodeData;	// Records appended while loading
+#endif
+#ifdef DICTIONARY_GOAL_BOUNDS
+	std::unordered_map<uint64_t, unsigned int> m_goalBoxIds;	// Box to id, only while loading
+#endif
+	PrecomputeStats m_stats;
 
-	template <typename T> void InitArray(T**& t, int width, int height);
-	template <typename T> void DestroyArray(T**& t);
+	template <typename T> void InitArray(T*& t, int width, int height);
+	template <typename T> void DestroyArray(T*& t);
 
 	void CalculateJumpPointMap();
 	void CalculateDistantJumpPointMap();
-	void CalculateGoalBounding();
-	bool IsJumpPoint(int r, int c, int rowDir, int colDir);
+	void CalculateGoalBounding(const char *filename, const BitGrid* oldGrid, const char *oldFilename);
+	bool CanSeeDirtyCells(int startRow, int startCol, const GoalBounds& oldBounds,
+		const std::vector<int>& dirtyRows, const std::vector<int>& dirtyCols);
+	void SaveRow(std::ostream& file, int r, GoalBounds* rowBounds);
+	void LoadRow(std::istream& file, int r, const BitGrid* grid, GoalBounds* rowBounds);
+	void StoreNodeData(int r, int c, const DistantJumpPoints& jumpPoints, const GoalBounds& bounds, std::vector<GoalBox>& goalBoxes);
 	bool IsEmpty(int r, int c);
 	bool IsWall(int r, int c);
 
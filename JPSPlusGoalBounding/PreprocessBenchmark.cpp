@@ -0,0 +1,322 @@
+/*
+ * PreprocessBenchmark.cpp
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include "stdafx.h"
+#include <vector>
+#include <fstream>
+#include <string>
+#include <stdlib.h>
+#include <math.h>
+#include "PreprocessBenchmark.h"
+#include "PrecomputeMap.h"
+#include "Timer.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Preprocessing is O(n^2) in the number of cells, so keep the largest size modest
+static const int benchmarkSizes[] = { 32, 48, 64, 96, 128 };
+static const int numBenchmarkSizes = sizeof(benchmarkSizes) / sizeof(benchmarkSizes[0]);
+
+enum BenchmarkMapType
+{
+	OpenMap,
+	RandomMap,
+	RoomMap,
+	MazeMap,
+	NumBenchmarkMapTypes
+};
+
+static const char* benchmarkMapNames[] = { "open", "random", "room", "maze" };
+
+struct BenchmarkResult
+{
+	int type;
+	int size;
+	int threads;
+	double totalSeconds;
+};
+
+// Small deterministic generator, so every run benchmarks the same maps
+static unsigned int BenchmarkRandom(unsigned int& seed)
+{
+	seed = (seed * 1103515245) + 12345;
+	return (seed >> 8) & 0xFFFFFF;
+}
+
+static void GenerateMap(int type, int size, std::vector<bool>& map)
+{
+	unsigned int seed = 12345 + size;
+	map.assign(size * size, true);
+
+	if (type == OpenMap || type == RandomMap)
+	{
+		// 5% or 33% scattered walls
+		unsigned int percent = (type == OpenMap) ? 5 : 33;
+		for (int i = 0; i < size * size; ++i)
+		{
+			map[i] = (BenchmarkRandom(seed) % 100) >= percent;
+		}
+	}
+	else if (type == RoomMap)
+	{
+		// 10x10 rooms with one door in every wall
+		const int roomSize = 10;
+		for (int r = 0; r < size; ++r)
+		{
+			for (int c = 0; c < size; ++c)
+			{
+				if (r % roomSize == 0 || c % roomSize == 0)
+				{
+					map[c + (r * size)] = false;
+				}
+			}
+		}
+		for (int r = 0; r < size; r += roomSize)
+		{
+			for (int c = 0; c < size; c += roomSize)
+			{
+				int doorCol = c + 1 + (BenchmarkRandom(seed) % (roomSize - 1));
+				int doorRow = r + 1 + (BenchmarkRandom(seed) % (roomSize - 1));
+				if (r > 0 && doorCol < size) { map[doorCol + (r * size)] = true; }
+				if (c > 0 && doorRow < size) { map[c + (doorRow * size)] = true; }
+			}
+		}
+	}
+	else if (type == MazeMap)
+	{
+		// Corridors one cell wide (depth first maze on the odd cells)
+		map.assign(size * size, false);
+		int cells = (size - 1) / 2;
+		std::vector<int> stack;
+		map[1 + size] = true;
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			int cell = stack.back();
+			int cellRow = cell / cells;
+			int cellCol = cell % cells;
+
+			static const int offsetRow[] = { 1, 0, -1, 0 };
+			static const int offsetCol[] = { 0, 1, 0, -1 };
+			int neighbors[4];
+			int numNeighbors = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				int r = cellRow + offsetRow[i];
+				int c = cellCol + offsetCol[i];
+				if (r >= 0 && r < cells && c >= 0 && c < cells && !map[(c * 2 + 1) + ((r * 2 + 1) * size)])
+				{
+					neighbors[numNeighbors++] = i;
+				}
+			}
+
+			if (numNeighbors == 0)
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			int i = neighbors[BenchmarkRandom(seed) % numNeighbors];
+			int r = cellRow + offsetRow[i];
+			int c = cellCol + offsetCol[i];
+			map[(cellCol * 2 + 1 + offsetCol[i]) + ((cellRow * 2 + 1 + offsetRow[i]) * size)] = true;
+			map[(c * 2 + 1) + ((r * 2 + 1) * size)] = true;
+			stack.push_back(c + (r * cells));
+		}
+	}
+}
+
+// High-water mark of the process memory, in MB
+static double GetPeakMemoryMB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	// VmHWM can be reset between runs, unlike ru_maxrss
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, 6, "VmHWM:") == 0)
+		{
+			return atol(line.c_str() + 6) / 1024.0;
+		}
+	}
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+// Lowers the high-water mark to the current usage, so the next peak belongs to one run.
+// Returns false where that isn't possible (Windows has no way to reset PeakWorkingSetSize).
+static bool ResetPeakMemory()
+{
+#ifdef _WIN32
+	return false;
+#else
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+	clearRefs.close();
+	return !clearRefs.fail();
+#endif
+}
+
+static long GetFileSize(const char *filename)
+{
+	std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+	return (long)file.tellg();
+}
+
+void RunPreprocessBenchmark(const char *csvFilename)
+{
+	const char* preFilename = "PreprocessBenchmark.pre";
+
+	std::vector<int> threadCounts;
+#ifdef _OPENMP
+	for (int threads = 1; threads < omp_get_num_procs(); threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(omp_get_num_procs());
+#else
+	threadCounts.push_back(1);
+#endif
+
+	std::ofstream csv(csvFilename);
+	csv << "type,width,height,threads,jumpPointSeconds,distantJumpPointSeconds,goalBoundingSeconds,"
+		"totalSeconds,floods,floodsPerSecond,peakMemoryMB,preBytes" << std::endl;
+
+	std::vector<BenchmarkResult> results;
+	for (int sizeIndex = 0; sizeIndex < numBenchmarkSizes; ++sizeIndex)
+	{
+		int size = benchmarkSizes[sizeIndex];
+		for (int type = 0; type < NumBenchmarkMapTypes; ++type)
+		{
+			std::vector<bool> map;
+			GenerateMap(type, size, map);
+			BitGrid grid(map, size, size);
+
+			for (unsigned int t = 0; t < threadCounts.size(); ++t)
+			{
+#ifdef _OPENMP
+				omp_set_num_threads(threadCounts[t]);
+#endif
+				bool peakWasReset = ResetPeakMemory();
+				double peakBeforeMB = GetPeakMemoryMB();
+
+				PrecomputeMap precomputeMap(&grid);
+				precomputeMap.CalculateMap(preFilename);
+				const PrecomputeStats& stats = precomputeMap.GetStats();
+
+				double totalSeconds = stats.jumpPointSeconds + stats.distantJumpPointSeconds + stats.goalBoundingSeconds;
+				double floodsPerSecond = stats.goalBoundingSeconds > 0 ? stats.numFloods / stats.goalBoundingSeconds : 0;
+				// Without a reset, the process peak only belongs to this run if the run raised it (-1 if unknown)
+				double peakMemoryMB = GetPeakMemoryMB();
+				if (!peakWasReset && peakMemoryMB <= peakBeforeMB)
+				{
+					peakMemoryMB = -1;
+				}
+				long preBytes = GetFileSize(preFilename);
+
+				printf("PREPROCESS\t%s\t%dx%d\tthreads\t%d\tjump-points\t%f\tdistant-jump-points\t%f\tgoal-bounding\t%f\t"
+					"total\t%f\tfloods/sec\t%.1f\tpeak-MB\t%.1f\tpre-bytes\t%ld\n",
+					benchmarkMapNames[type], size, size, threadCounts[t], stats.jumpPointSeconds, stats.distantJumpPointSeconds,
+					stats.goalBoundingSeconds, totalSeconds, floodsPerSecond, peakMemoryMB, preBytes);
+
+				csv << benchmarkMapNames[type] << "," << size << "," << size << "," << threadCounts[t] << ","
+					<< stats.jumpPointSeconds << "," << stats.distantJumpPointSeconds << "," << stats.goalBoundingSeconds << ","
+					<< totalSeconds << "," << stats.numFloods << "," << floodsPerSecond << ","
+					<< peakMemoryMB << "," << preBytes << std::endl;
+
+				BenchmarkResult result = { type, size, threadCounts[t], totalSeconds };
+				results.push_back(result);
+
+				precomputeMap.ReleaseMap();
+			}
+		}
+	}
+	remove(preFilename);
+
+	// Least squares fit of log(time) = log(a) + b * log(cells), for each map type and thread count
+	for (int type = 0; type < NumBenchmarkMapTypes; ++type)
+	{
+		for (unsigned int t = 0; t < threadCounts.size(); ++t)
+		{
+			double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+			int n = 0;
+			for (unsigned int i = 0; i < results.size(); ++i)
+			{
+				if (results[i].type != type || results[i].threads != threadCounts[t] || results[i].totalSeconds <= 0)
+				{
+					continue;
+				}
+
+				double x = log((double)results[i].size * results[i].size);
+				double y = log(results[i].totalSeconds);
+				sumX += x;
+				sumY += y;
+				sumXX += x * x;
+				sumXY += x * y;
+				n++;
+			}
+
+			if (n < 2)
+			{
+				continue;
+			}
+
+			double exponent = ((n * sumXY) - (sumX * sumY)) / ((n * sumXX) - (sumX * sumX));
+			double constant = exp((sumY - (exponent * sumX)) / n);
+			printf("PREPROCESS-FIT\t%s\tthreads\t%d\ttime = %g * cells^%.2f\n",
+				benchmarkMapNames[type], threadCounts[t], constant, exponent);
+		}
+	}
+}
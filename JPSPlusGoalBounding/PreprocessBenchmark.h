@@ -1,9 +1,20 @@
 /*
- * GenericHeap.cpp
+ * PreprocessBenchmark.h
  *
- * Copyright (c) 2007, Nathan Sturtevant
+ * Copyright (c) 2014-2015, Steve Rabin
  * All rights reserved.
  *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
  *     * Redistributions of source code must retain the above copyright
@@ -11,11 +22,10 @@
  *     * Redistributions in binary form must reproduce the above copyright
  *       notice, this list of conditions and the following disclaimer in the
  *       documentation and/or other materials provided with the distribution.
- *     * Neither the name of the University of Alberta nor the
- *       names of its contributors may be used to endorse or promote products
+ *     * The name of the author may not be used to endorse or promote products
  *       derived from this software without specific prior written permission.
  *
- * THIS SOFTWARE IS PROVIDED BY NATHAN STURTEVANT ``AS IS'' AND ANY
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
  * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
  * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
  * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
@@ -27,5 +37,12 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */ 
 
-#include "stdafx.h"
-#include "GenericHeap.h"
+#pragma once
+
+// Benchmark of the preprocessing pipeline (not the searches).
+// Preprocesses generated maps of increasing size for every map type and thread count,
+// printing the time of each phase, floods/sec, peak memory and .pre size (also saved
+// as CSV), then fits the total time of each map type to a power curve.
+// Enable with BENCHMARK_PREPROCESSING in main.cpp.
+
+void RunPreprocessBenchmark(const char *csvFilename);
@@ -39,27 +39,258 @@
 
 #include "StdAfx.h"
 #include "SimpleUnsortedPriorityQueue.h"
+#include <malloc.h>
+
+// Unsigned 32-bit vector min is SSE4.1, there's no 64-bit one before AVX-512
+#if defined(SIMD_OPEN_LIST_SCAN) && defined(LARGE_MAP_MODE)
+#undef SIMD_OPEN_LIST_SCAN
+#endif
+
+// Only use the intrinsics when the target has them (MSVC defines neither macro below /arch:AVX)
+#if defined(SIMD_OPEN_LIST_SCAN) && !defined(__SSE4_1__) && !defined(__AVX__) && !defined(__AVX2__)
+#undef SIMD_OPEN_LIST_SCAN
+#endif
+
+#ifdef SIMD_OPEN_LIST_SCAN
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#define HEAP_ARITY 4
+
+SimpleUnsortedPriorityQueue::SimpleUnsortedPriorityQueue(int arraySize)
+: m_nextFreeNode(0), m_addLimit(UnsortedLimit), m_arraySize(arraySize < UnsortedLimit ? UnsortedLimit : arraySize)
+{
+	m_nodeArray = new PathfindingNode*[m_arraySize];
+	m_costArray = AllocateCostArray(m_arraySize);
+}
+
+SimpleUnsortedPriorityQueue::~SimpleUnsortedPriorityQueue(void)
+{
+	delete[] m_nodeArray;
+	_aligned_free(m_costArray);
+}
+
+PathCost* SimpleUnsortedPriorityQueue::AllocateCostArray(int size)
+{
+	return (PathCost*)_aligned_malloc(sizeof(PathCost) * (size + ScanWidth), 64);
+}
 
 PathfindingNode* SimpleUnsortedPriorityQueue::Pop(void)
 {
-	// Find the cheapest node
-	unsigned int cheapestNodeCost = m_nodeArray[0]->m_finalCost;
+	if (IsHeap())
+	{
+		return HeapPop();
+	}
+
+	while (m_nextFreeNode > 0)
+	{
+		// Find the cheapest node
+		int cheapestNodeIndex = FindCheapest();
+
+		// Remember the cheapest node
+		PathfindingNode* cheapestNode = m_nodeArray[cheapestNodeIndex];
+		PathCost cheapestNodeCost = m_costArray[cheapestNodeIndex];
+
+		// Delete off list (put the last node where this one was)
+		--m_nextFreeNode;
+		m_nodeArray[cheapestNodeIndex] = m_nodeArray[m_nextFreeNode];
+		m_costArray[cheapestNodeIndex] = m_costArray[m_nextFreeNode];
+
+		if (IsCurrent(cheapestNode, cheapestNodeCost))
+		{
+			return cheapestNode;
+		}
+	}
+
+	return 0;
+}
+
+// Index of the first of the cheapest nodes
+int SimpleUnsortedPriorityQueue::FindCheapest(void)
+{
+#ifdef SIMD_OPEN_LIST_SCAN
+	// Most open lists hold a handful of nodes, too few to pay for the vector setup
+	if (m_nextFreeNode > VectorScanMinimum)
+	{
+		return FindCheapestVector();
+	}
+#endif
+
+	PathCost cheapestNodeCost = m_costArray[0];
 	int cheapestNodeIndex = 0;
 
 	for (int i = 1; i < m_nextFreeNode; ++i)
 	{
-		if (m_nodeArray[i]->m_finalCost < cheapestNodeCost)
+		if (m_costArray[i] < cheapestNodeCost)
 		{
-			cheapestNodeCost = m_nodeArray[i]->m_finalCost;
+			cheapestNodeCost = m_costArray[i];
 			cheapestNodeIndex = i;
 		}
 	}
 
-	// Remember the cheapest node
-	PathfindingNode* cheapestNode = m_nodeArray[cheapestNodeIndex];
+	return cheapestNodeIndex;
+}
+
+#ifdef SIMD_OPEN_LIST_SCAN
+int SimpleUnsortedPriorityQueue::FindCheapestVector(void)
+{
+	// Pad the costs to whole vectors with the highest cost
+	int end = (m_nextFreeNode + ScanWidth - 1) & ~(ScanWidth - 1);
+	for (int i = m_nextFreeNode; i < end; ++i)
+	{
+		m_costArray[i] = 0xFFFFFFFF;
+	}
+
+	// Minimum of each lane, then of the lanes
+#ifdef __AVX2__
+	__m256i lanes = _mm256_load_si256((const __m256i*)m_costArray);
+	for (int i = 8; i < end; i += 8)
+	{
+		lanes = _mm256_min_epu32(lanes, _mm256_load_si256((const __m256i*)&m_costArray[i]));
+	}
+	__m128i cheapest = _mm_min_epu32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+#else
+	__m128i cheapest = _mm_min_epu32(_mm_load_si128((const __m128i*)m_costArray), _mm_load_si128((const __m128i*)&m_costArray[4]));
+	for (int i = 8; i < end; i += 4)
+	{
+		cheapest = _mm_min_epu32(cheapest, _mm_load_si128((const __m128i*)&m_costArray[i]));
+	}
+#endif
+	cheapest = _mm_min_epu32(cheapest, _mm_shuffle_epi32(cheapest, _MM_SHUFFLE(1, 0, 3, 2)));
+	cheapest = _mm_min_epu32(cheapest, _mm_shuffle_epi32(cheapest, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	// First entry with that cost, it's there so this ends
+	for (int i = 0; ; i += 4)
+	{
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_load_si128((const __m128i*)&m_costArray[i]), cheapest)));
+		if (mask != 0)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, (unsigned long)mask);
+			return i + (int)index;
+#else
+			return i + __builtin_ctz(mask);
+#endif
+		}
+	}
+}
+#endif
 
-	// Delete off list (put the last node where this one was)
-	m_nodeArray[cheapestNodeIndex] = m_nodeArray[--m_nextFreeNode];
+void SimpleUnsortedPriorityQueue::HeapAdd(PathfindingNode* node)
+{
+	if (!IsHeap())
+	{
+		// Too many nodes to keep scanning, heapify them
+		m_addLimit = 0;
+		for (int i = (m_nextFreeNode - 2) / HEAP_ARITY; i >= 0; --i)
+		{
+			SiftDown(i, m_nodeArray[i], m_costArray[i]);
+		}
+	}
+
+	if (m_nextFreeNode == m_arraySize)
+	{
+		Grow();
+	}
+
+	SiftUp(m_nextFreeNode++, node, node->m_finalCost);
+}
+
+PathfindingNode* SimpleUnsortedPriorityQueue::HeapPop(void)
+{
+	while (m_nextFreeNode > 0)
+	{
+		PathfindingNode* cheapestNode = m_nodeArray[0];
+		PathCost cheapestNodeCost = m_costArray[0];
+
+		// Move the last node to the root and let it sink
+		--m_nextFreeNode;
+		if (m_nextFreeNode > 0)
+		{
+			SiftDown(0, m_nodeArray[m_nextFreeNode], m_costArray[m_nextFreeNode]);
+		}
+
+		if (IsCurrent(cheapestNode, cheapestNodeCost))
+		{
+			return cheapestNode;
+		}
+	}
+
+	return 0;
+}
+
+// Moves the hole at index up until the node fits, then places the node there
+void SimpleUnsortedPriorityQueue::SiftUp(int index, PathfindingNode* node, PathCost cost)
+{
+	while (index > 0)
+	{
+		int parent = (index - 1) / HEAP_ARITY;
+		if (m_costArray[parent] <= cost)
+		{
+			break;
+		}
+
+		m_nodeArray[index] = m_nodeArray[parent];
+		m_costArray[index] = m_costArray[parent];
+		index = parent;
+	}
+
+	m_nodeArray[index] = node;
+	m_costArray[index] = cost;
+}
+
+// Moves the hole at index down until the node fits, then places the node there
+void SimpleUnsortedPriorityQueue::SiftDown(int index, PathfindingNode* node, PathCost cost)
+{
+	while (true)
+	{
+		int firstChild = (index * HEAP_ARITY) + 1;
+		if (firstChild >= m_nextFreeNode)
+		{
+			break;
+		}
+
+		// Find the cheapest child
+		int lastChild = firstChild + HEAP_ARITY;
+		if (lastChild > m_nextFreeNode) { lastChild = m_nextFreeNode; }
+
+		int cheapestChild = firstChild;
+		for (int child = firstChild + 1; child < lastChild; ++child)
+		{
+			if (m_costArray[child] < m_costArray[cheapestChild])
+			{
+				cheapestChild = child;
+			}
+		}
+
+		if (cost <= m_costArray[cheapestChild])
+		{
+			break;
+		}
+
+		m_nodeArray[index] = m_nodeArray[cheapestChild];
+		m_costArray[index] = m_costArray[cheapestChild];
+		index = cheapestChild;
+	}
+
+	m_nodeArray[index] = node;
+	m_costArray[index] = cost;
+}
+
+void SimpleUnsortedPriorityQueue::Grow()
+{
+	PathfindingNode** nodeArray = new PathfindingNode*[m_arraySize * 2];
+	PathCost* costArray = AllocateCostArray(m_arraySize * 2);
+	memcpy(nodeArray, m_nodeArray, sizeof(PathfindingNode*) * m_nextFreeNode);
+	memcpy(costArray, m_costArray, sizeof(PathCost) * m_nextFreeNode);
+	delete[] m_nodeArray;
+	_aligned_free(m_costArray);
 
-	return cheapestNode;
+	m_nodeArray = nodeArray;
+	m_costArray = costArray;
+	m_arraySize *= 2;
 }
@@ -43,22 +43,62 @@
 // This priority queue only makes sense when the open list on average contains 
 // fewer than 10 elements. This is the case for JPS+ with Goal Bounding when
 // a fast stack is being used in conjunction with the open list.
+//
+// For the searches where it doesn't (large open maps, weak goal bounds), an open list that
+// grows past UnsortedLimit nodes becomes a 4-ary min heap for the rest of the search. The
+// arrays grow as needed.
+//
+// The cost each node was added at is kept in a parallel array, so finding the cheapest one
+// scans costs rather than loading every node, with SSE4.1 or AVX2 once there are more than a
+// few. The vector scan needs the compiler to target one of them (/arch:AVX2 in the Release
+// build, -msse4.1 or -mavx2 elsewhere); other builds keep the scalar loop. A node that gets
+// cheaper is added again (see DecreaseKey), and the entries it leaves behind are dropped when
+// they come out.
+
+#define SIMD_OPEN_LIST_SCAN		// Vector min-scan of the costs (scalar with the 64-bit costs of the large map mode)
 
-#pragma once
 class SimpleUnsortedPriorityQueue
 {
 public:
-	SimpleUnsortedPriorityQueue(int arraySize) : m_nextFreeNode(0) { m_nodeArray = new PathfindingNode*[arraySize]; }
-	~SimpleUnsortedPriorityQueue(void) { delete[] m_nodeArray; }
+	SimpleUnsortedPriorityQueue(int arraySize);
+	~SimpleUnsortedPriorityQueue(void);
 
-	inline void Reset() { m_nextFreeNode = 0; }
+	inline void Reset() { m_nextFreeNode = 0; m_addLimit = UnsortedLimit; }
 	inline bool Empty(void) { return m_nextFreeNode == 0; }
-	inline void Add(PathfindingNode* node) { m_nodeArray[m_nextFreeNode++] = node; }
-	PathfindingNode* Pop(void);
+	inline void Add(PathfindingNode* node)
+	{
+		if (m_nextFreeNode < m_addLimit)
+		{
+			m_nodeArray[m_nextFreeNode] = node;
+			m_costArray[m_nextFreeNode++] = node->m_finalCost;
+		}
+		else { HeapAdd(node); }
+	}
+	inline void DecreaseKey(PathfindingNode* node) { Add(node); }	// Whether the node is in here or on the fast stack
+	PathfindingNode* Pop(void);	// 0 when only dropped entries were left
 
 private:
+	enum { UnsortedLimit = 64, VectorScanMinimum = 16, ScanWidth = 8 };	// The cost array has ScanWidth spare slots to pad the scan
+
 	int m_nextFreeNode;
+	int m_addLimit;		// UnsortedLimit until the open list becomes a heap, then 0
+	int m_arraySize;
 	bool m_identical;
 	PathfindingNode** m_nodeArray;
-};
+	PathCost* m_costArray;	// 64 byte aligned
 
+	inline bool IsHeap() { return m_addLimit == 0; }
+	inline bool IsCurrent(PathfindingNode* node, PathCost cost)
+	{
+		// Not if the node got cheaper since (it was added again) or was closed off the fast stack
+		return cost == node->m_finalCost && node->m_listStatus != PathfindingNode::OnClosed;
+	}
+	int FindCheapest(void);
+	int FindCheapestVector(void);
+	void HeapAdd(PathfindingNode* node);
+	PathfindingNode* HeapPop(void);
+	void SiftUp(int index, PathfindingNode* node, PathCost cost);
+	void SiftDown(int index, PathfindingNode* node, PathCost cost);
+	void Grow();
+	PathCost* AllocateCostArray(int size);
+};
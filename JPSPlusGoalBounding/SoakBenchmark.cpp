@@ -0,0 +1,189 @@
+/*
+ * SoakBenchmark.cpp
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include "stdafx.h"
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include "SoakBenchmark.h"
+#include "ScenarioLoader.h"
+#include "Entry.h"
+#include "Timer.h"
+
+// Searches per latency window
+static const int soakWindowQueries = 1000000;
+
+void LoadMap(const char *fname, std::vector<bool> &map, int &width, int &height);	// In main.cpp
+
+// Same checks as the searches in main.cpp: connected, no corner cutting, right end points and length
+static bool IsValidPath(const std::vector<xyLoc> &path, const Experiment &experiment, int width, const std::vector<bool> &map)
+{
+	if (path.empty() ||
+		path[0].x != experiment.GetStartX() || path[0].y != experiment.GetStartY() ||
+		path.back().x != experiment.GetGoalX() || path.back().y != experiment.GetGoalY())
+	{
+		return false;
+	}
+
+	double length = 0;
+	for (unsigned int i = 0; i + 1 < path.size(); i++)
+	{
+		int dx = abs(path[i + 1].x - path[i].x);
+		int dy = abs(path[i + 1].y - path[i].y);
+		if (dx > 1 || dy > 1 || !map[path[i + 1].y * width + path[i + 1].x])
+		{
+			return false;
+		}
+		if (dx != 0 && dy != 0)
+		{
+			if (!map[path[i + 1].y * width + path[i].x] || !map[path[i].y * width + path[i + 1].x])
+			{
+				return false;
+			}
+			length += 1.41421356;
+		}
+		else
+		{
+			length += 1;
+		}
+	}
+	return fabs(length - experiment.GetDistance()) <= experiment.GetDistance() * 0.000005;
+}
+
+void RunSoakBenchmark(const char *mapFilename, long long numQueries, const char *csvFilename)
+{
+	char scenarioFilename[2048];
+	char preprocessedFilename[2048];
+	sprintf(scenarioFilename, "%s.scen", mapFilename);
+	sprintf(preprocessedFilename, "%s.pre", mapFilename);
+
+	std::vector<bool> map;
+	int width, height;
+	LoadMap(mapFilename, map, width, height);
+	std::ifstream preprocessedFile(preprocessedFilename);
+	if (!preprocessedFile)
+	{
+		PreprocessMap(map, width, height, preprocessedFilename);
+	}
+	void *search = PrepareForSearch(map, width, height, preprocessedFilename);
+
+	// Searches with the same start and goal are skipped, as in main.cpp
+	ScenarioLoader scen(scenarioFilename);
+	std::vector<Experiment> experiments;
+	for (int x = 0; x < scen.GetNumExperiments(); x++)
+	{
+		Experiment experiment = scen.GetNthExperiment(x);
+		if (experiment.GetStartX() != experiment.GetGoalX() || experiment.GetStartY() != experiment.GetGoalY())
+		{
+			experiments.push_back(experiment);
+		}
+	}
+	if (experiments.empty())
+	{
+		printf("SOAK\t%s\tno scenarios\n", mapFilename);
+		ReleaseSearch(search);
+		return;
+	}
+
+	std::ofstream csv(csvFilename);
+	csv << "window,queries,meanMicroseconds,p99Microseconds,maxMicroseconds,failures" << std::endl;
+
+	std::vector<float> times;
+	times.reserve(soakWindowQueries);
+	std::vector<xyLoc> path;
+	Timer timer;
+	long long query = 0;
+	long long totalFailures = 0;
+	double firstMean = 0, lastMean = 0, worstMax = 0;
+	for (int window = 0; query < numQueries; window++)
+	{
+		times.clear();
+		double windowTotal = 0;
+		int failures = 0;
+		for (; query < numQueries && (int)times.size() < soakWindowQueries; query++)
+		{
+			const Experiment &experiment = experiments[query % experiments.size()];
+			xyLoc s, g;
+			s.x = experiment.GetStartX();
+			s.y = experiment.GetStartY();
+			g.x = experiment.GetGoalX();
+			g.y = experiment.GetGoalY();
+
+			path.resize(0);
+			timer.StartTimer();
+			while (!GetPath(search, s, g, path)) {}
+			timer.EndTimer();
+
+			double microseconds = timer.GetElapsedSeconds() * 1000000.0;
+			times.push_back((float)microseconds);
+			windowTotal += microseconds;
+			if (!IsValidPath(path, experiment, width, map))
+			{
+				failures++;
+			}
+		}
+
+		double mean = windowTotal / times.size();
+		std::vector<float>::iterator p99 = times.begin() + (times.size() * 99) / 100;
+		std::nth_element(times.begin(), p99, times.end());
+		double maxTime = *std::max_element(times.begin(), times.end());
+
+		printf("SOAK\t%s\twindow\t%d\tqueries\t%lld\tmean-us\t%f\tp99-us\t%f\tmax-us\t%f\tfailures\t%d\n",
+			mapFilename, window, query, mean, *p99, maxTime, failures);
+		csv << window << "," << query << "," << mean << "," << *p99 << "," << maxTime << "," << failures << std::endl;
+
+		if (window == 0)
+		{
+			firstMean = mean;
+		}
+		lastMean = mean;
+		if (maxTime > worstMax)
+		{
+			worstMax = maxTime;
+		}
+		totalFailures += failures;
+	}
+
+	printf("SOAK-SUMMARY\t%s\tqueries\t%lld\tfailures\t%lld\tfirst-mean-us\t%f\tlast-mean-us\t%f\tworst-max-us\t%f\n",
+		mapFilename, query, totalFailures, firstMean, lastMean, worstMax);
+
+	ReleaseSearch(search);
+}
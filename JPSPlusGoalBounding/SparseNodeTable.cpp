@@ -0,0 +1,140 @@
+/*
+ * SparseNodeTable.cpp
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#include "StdAfx.h"
+#include "SparseNodeTable.h"
+
+SparseNodeTable::SparseNodeTable(int initialCapacity)
+: m_numNodes(0)
+{
+	m_capacity = 16;
+	m_hashShift = 28;
+	while (m_capacity < (unsigned int)initialCapacity)
+	{
+		m_capacity <<= 1;
+		m_hashShift--;
+	}
+
+	m_slots = new Slot[m_capacity];
+	memset(m_slots, 0xFF, sizeof(Slot) * m_capacity);	// EmptySlot
+}
+
+SparseNodeTable::~SparseNodeTable()
+{
+	delete[] m_slots;
+	for (unsigned int i = 0; i < m_poolBlocks.size(); i++)
+	{
+		delete[] m_poolBlocks[i];
+	}
+}
+
+void SparseNodeTable::Reset(void)
+{
+	m_numNodes = 0;
+}
+
+PathfindingNode* SparseNodeTable::GetNode(unsigned int cellIndex)
+{
+	unsigned int mask = m_capacity - 1;
+	unsigned int slot = GetHome(cellIndex);
+
+	while (true)
+	{
+		Slot& s = m_slots[slot];
+		if (s.poolIndex >= m_numNodes || GetPoolNode(s.poolIndex)->cellIndex != s.cellIndex)
+		{
+			// Free slot, the cell has no node yet
+			break;
+		}
+		if (s.cellIndex == cellIndex)
+		{
+			return &GetPoolNode(s.poolIndex)->node;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	if ((m_numNodes + 1) * 2 > m_capacity)
+	{
+		Grow();
+		return GetNode(cellIndex);
+	}
+
+	if (m_numNodes == m_poolBlocks.size() * PoolBlockSize)
+	{
+		m_poolBlocks.push_back(new SparseNode[PoolBlockSize]);
+	}
+
+	unsigned int poolIndex = m_numNodes++;
+	SparseNode* sparseNode = GetPoolNode(poolIndex);
+	sparseNode->cellIndex = cellIndex;
+	sparseNode->node.m_listStatus = PathfindingNode::OnNone;
+	sparseNode->node.m_iteration = 0;
+
+	m_slots[slot].cellIndex = cellIndex;
+	m_slots[slot].poolIndex = poolIndex;
+	return &sparseNode->node;
+}
+
+void SparseNodeTable::Grow(void)
+{
+	// Only the table moves, the nodes stay where they are
+	delete[] m_slots;
+	m_capacity <<= 1;
+	m_hashShift--;
+	m_slots = new Slot[m_capacity];
+	memset(m_slots, 0xFF, sizeof(Slot) * m_capacity);	// EmptySlot
+
+	unsigned int mask = m_capacity - 1;
+	for (unsigned int poolIndex = 0; poolIndex < m_numNodes; poolIndex++)
+	{
+		unsigned int cellIndex = GetPoolNode(poolIndex)->cellIndex;
+		unsigned int slot = GetHome(cellIndex);
+		while (m_slots[slot].poolIndex != EmptySlot)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot].cellIndex = cellIndex;
+		m_slots[slot].poolIndex = poolIndex;
+	}
+}
+
+size_t SparseNodeTable::GetBytesUsed(void)
+{
+	return sizeof(Slot) * m_capacity + sizeof(SparseNode) * PoolBlockSize * m_poolBlocks.size();
+}
@@ -0,0 +1,87 @@
+/*
+ * SparseNodeTable.h
+ *
+ * Copyright (c) 2014-2015, Steve Rabin
+ * All rights reserved.
+ *
+ * An explanation of the JPS+ algorithm is contained in Chapter 14
+ * of the book Game AI Pro 2, edited by Steve Rabin, CRC Press, 2015.
+ * A presentation on Goal Bounding titled "JPS+: Over 100x Faster than A*"
+ * can be found at www.gdcvault.com from the 2015 GDC AI Summit.
+ * A copy of this code is on the website http://www.gameaipro.com.
+ *
+ * If you develop a way to improve this code or make it faster, please
+ * contact steve.rabin@gmail.com and share your insights. I would
+ * be equally eager to hear from anyone integrating this code or using
+ * the Goal Bounding concept in a commercial application or game.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * The name of the author may not be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY STEVE RABIN ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */ 
+
+#pragma once
+#include "PathfindingNode.h"
+#include <vector>
+
+// Search nodes for only the cells a search touches, instead of one per map cell.
+// An open addressing table (linear probing) maps a cell index to a node in a pool.
+// The pool is allocated in blocks that never move, so the open list keeps pointers
+// to nodes while the table grows. Both are sized by the largest search so far.
+
+class SparseNodeTable
+{
+public:
+	SparseNodeTable(int initialCapacity);
+	~SparseNodeTable();
+
+	void Reset(void);	// Forget every node (done once per search, in constant time)
+	PathfindingNode* GetNode(unsigned int cellIndex);	// The first call for a cell adds a fresh node
+	inline unsigned int GetCellIndex(PathfindingNode* node) { return ((SparseNode*)node)->cellIndex; }
+	size_t GetBytesUsed(void);
+
+private:
+	struct SparseNode
+	{
+		PathfindingNode node;	// First, so a node pointer is also a SparseNode pointer
+		unsigned int cellIndex;
+	};
+
+	struct Slot
+	{
+		unsigned int cellIndex;
+		unsigned int poolIndex;
+	};
+
+	enum { PoolBlockShift = 12, PoolBlockSize = 1 << PoolBlockShift };
+	static const unsigned int EmptySlot = 0xFFFFFFFF;
+
+	inline SparseNode* GetPoolNode(unsigned int poolIndex) { return &m_poolBlocks[poolIndex >> PoolBlockShift][poolIndex & (PoolBlockSize - 1)]; }
+	inline unsigned int GetHome(unsigned int cellIndex) { return (cellIndex * 2654435761u) >> m_hashShift; }
+	void Grow(void);
+
+	// A slot is in use only if it points below m_numNodes at a node of its own cell.
+	// Slots left from earlier searches fail that test, so Reset doesn't clear them.
+	Slot* m_slots;
+	unsigned int m_capacity;	// Power of two, at least twice m_numNodes
+	int m_hashShift;
+	unsigned int m_numNodes;
+	std::vector<SparseNode*> m_poolBlocks;
+};
@@ -47,6 +47,7 @@ public:
 	void StartTimer();
 	double EndTimer();
 	double GetElapsedTime(){return elapsedTime;}
+	double GetElapsedSeconds(){return elapsedTime / (double)ticksPerSecond.QuadPart;}
 
 	inline double GetHighestResolutionTime(void)	{ LARGE_INTEGER qwTime; QueryPerformanceCounter(&qwTime); return((double)qwTime.QuadPart); }
 };
@@ -43,54 +43,68 @@
 //#define TRACK_IDENTICAL_OPTIMIZATION
 //#define ALL_NODES_EQUAL_COST	// ~40% faster and still results in optimal paths in virtually all cases
 
-UnsortedPriorityQueue::UnsortedPriorityQueue(int arraySize)
-: m_nextFreeNode(0), m_iteration(0)
+UnsortedPriorityQueue::UnsortedPriorityQueue(int arraySize, unsigned int* openListIndex)
+: m_nextFreeNode(0), m_arraySize(arraySize), m_identical(true), m_openListIndex(openListIndex)
 {
-	m_nodeArray = new DijkstraPathfindingNode*[arraySize];
+	m_nodeArray = new unsigned int[arraySize];
+	m_costArray = new PathCost[arraySize];
 }
 
 UnsortedPriorityQueue::~UnsortedPriorityQueue()
 {
 	delete[] m_nodeArray;
+	delete[] m_costArray;
 }
 
-void UnsortedPriorityQueue::Push(DijkstraPathfindingNode* node)
+void UnsortedPriorityQueue::Push(unsigned int node, PathCost cost)
 {
-	if (m_iteration != node->m_iteration)
+#ifdef TRACK_IDENTICAL_OPTIMIZATION
+	if (m_nextFreeNode == 0)
 	{
-		m_nextFreeNode = 0;
 		m_identical = true;
-		m_iteration = node->m_iteration;
 	}
-#ifdef TRACK_IDENTICAL_OPTIMIZATION
 	else if(m_identical)
 	{
-		m_identical = node->m_finalCost == m_nodeArray[0]->m_finalCost;
+		m_identical = cost == m_costArray[0];
 	}
-	else
+#endif
+
+	if (m_nextFreeNode == m_arraySize)
 	{
-		m_identical = m_nextFreeNode == 0;
+		Grow();
 	}
-#endif
 
-	m_nodeArray[m_nextFreeNode++] = node;
+	m_openListIndex[node] = m_nextFreeNode;
+	m_nodeArray[m_nextFreeNode] = node;
+	m_costArray[m_nextFreeNode] = cost;
+	m_nextFreeNode++;
+}
+
+void UnsortedPriorityQueue::Grow()
+{
+	unsigned int* nodeArray = new unsigned int[m_arraySize * 2];
+	PathCost* costArray = new PathCost[m_arraySize * 2];
+	memcpy(nodeArray, m_nodeArray, sizeof(unsigned int) * m_nextFreeNode);
+	memcpy(costArray, m_costArray, sizeof(PathCost) * m_nextFreeNode);
+	delete[] m_nodeArray;
+	delete[] m_costArray;
 
+	m_nodeArray = nodeArray;
+	m_costArray = costArray;
+	m_arraySize *= 2;
 }
 
-void UnsortedPriorityQueue::Remove(DijkstraPathfindingNode* node)
+void UnsortedPriorityQueue::Remove(unsigned int node)
 {
-	for (int i = 0; i < m_nextFreeNode; ++i)
-	{
-		if (m_nodeArray[i] == node)
-		{
-			// Delete off Open list (put last node where this one was)
-			m_nodeArray[i] = m_nodeArray[--m_nextFreeNode];
-			return;
-		}
-	}
+	// Delete off Open list (put last node where this one was)
+	int index = m_openListIndex[node];
+	--m_nextFreeNode;
+	m_nodeArray[index] = m_nodeArray[m_nextFreeNode];
+	m_costArray[index] = m_costArray[m_nextFreeNode];
+	m_openListIndex[m_nodeArray[index]] = index;
 }
 
-DijkstraPathfindingNode* UnsortedPriorityQueue::Pop(void)
+unsigned int UnsortedPriorityQueue::Pop(void)
 {
 #ifdef ALL_NODES_EQUAL_COST
 	// Just pop last node (all nodes are very close to each other in cost)
@@ -105,23 +119,26 @@ DijkstraPathfindingNode* UnsortedPriorityQueue::Pop(void)
 #endif
 
 	// Find cheapest node
-	unsigned int cheapestNodeCostFinal = m_nodeArray[0]->m_givenCost;
+	PathCost cheapestNodeCostFinal = m_costArray[0];
 	int cheapestNodeIndex = 0;
 
 	for (int i = 1; i < m_nextFreeNode; ++i)
 	{
-		if (m_nodeArray[i]->m_givenCost < cheapestNodeCostFinal)
+		if (m_costArray[i] < cheapestNodeCostFinal)
 		{
-			cheapestNodeCostFinal = m_nodeArray[i]->m_givenCost;
+			cheapestNodeCostFinal = m_costArray[i];
 			cheapestNodeIndex = i;
 		}
 	}
 
 	// Remember cheapest node
-	DijkstraPathfindingNode* cheapestNode = m_nodeArray[cheapestNodeIndex];
+	unsigned int cheapestNode = m_nodeArray[cheapestNodeIndex];
 
 	// Delete off Open list (put last node where this one was)
-	m_nodeArray[cheapestNodeIndex] = m_nodeArray[--m_nextFreeNode];
+	--m_nextFreeNode;
+	m_nodeArray[cheapestNodeIndex] = m_nodeArray[m_nextFreeNode];
+	m_costArray[cheapestNodeIndex] = m_costArray[m_nextFreeNode];
+	m_openListIndex[m_nodeArray[cheapestNodeIndex]] = cheapestNodeIndex;
 
 	return cheapestNode;
 #endif
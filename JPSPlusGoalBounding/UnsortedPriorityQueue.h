@@ -38,30 +38,34 @@
  */ 
 
 #pragma once
-#include "PathfindingNode.h"
+#include "MapTypes.h"
 
-// This array is dangerous since there are no safeguards if the max size is exceeded.
-// However, any method to detect a problem and deal with it gracefully will sacrifice speed.
+// Unsorted bucket of open nodes. Nodes are cell indices and their costs are kept in a
+// parallel array, so finding the cheapest node is a scan over contiguous memory.
+// Each node's position is written to the shared openListIndex array for constant time removal.
+// The arrays start at the given size and double whenever they fill up.
 // In this code base, this is only used by the Dijkstra floodfill for Goal Bounding preprocessing.
 
 class UnsortedPriorityQueue
 {
 public:
 
-	UnsortedPriorityQueue(int arraySize);
+	UnsortedPriorityQueue(int arraySize, unsigned int* openListIndex);
 	~UnsortedPriorityQueue();
 
-	inline bool Empty(int iteration) { if(m_iteration == iteration) { return m_nextFreeNode == 0; } else { return true; } }
-	inline int GetIteration() { return m_iteration; }
-	void Push(DijkstraPathfindingNode* node);
-	void Remove(DijkstraPathfindingNode* node);
-	DijkstraPathfindingNode* Pop(void);
+	inline void Reset() { m_nextFreeNode = 0; }
+	inline bool Empty() { return m_nextFreeNode == 0; }
+	void Push(unsigned int node, PathCost cost);
+	void Remove(unsigned int node);
+	unsigned int Pop(void);
 
 private:
 	int m_nextFreeNode;
-	int m_iteration;
+	int m_arraySize;
 	bool m_identical;
-	DijkstraPathfindingNode** m_nodeArray;
+	unsigned int* m_nodeArray;
+	PathCost* m_costArray;
+	unsigned int* m_openListIndex;
 
+	void Grow();
 };
-
@@ -16,6 +16,8 @@
 #include "ScenarioLoader.h"
 #include "Timer.h"
 #include "Entry.h"
+#include "PreprocessBenchmark.h"
+#include "SoakBenchmark.h"
 #include <stdlib.h>
 
 #include <windows.h>
@@ -24,6 +26,16 @@
 #include <iostream>
 #include <fstream>
 
+//#define BENCHMARK_PREPROCESSING	// Benchmark the preprocessing on generated maps instead of running the searches
+//#define BENCHMARK_SOAK			// Run hundreds of millions of searches on each map, checking the paths and the latency
+
+#ifdef BENCHMARK_SOAK
+// Maps soaked by default, a map and query count on the command line replace them
+static const char* soakMapFilenames[] = { "Maps\\maze-100-1.map", "Maps\\random-100-33.map", "Maps\\room-100-10.map" };
+static const int numSoakMaps = sizeof(soakMapFilenames) / sizeof(soakMapFilenames[0]);
+static const long long soakQueriesPerMap = 300000000;	// About 4500 wraps of the 16-bit search stamp
+#endif
+
 void LoadMap(const char *fname, std::vector<bool> &map, int &w, int &h);
 
 struct stats {
@@ -87,6 +99,27 @@ struct stats {
 
 int _tmain(int argc, char* argv[])
 {
+#ifdef BENCHMARK_PREPROCESSING
+	RunPreprocessBenchmark("PreprocessBenchmark.csv");
+	return 0;
+#endif
+#ifdef BENCHMARK_SOAK
+	if (argc > 1)
+	{
+		char csvFilename[2048];
+		sprintf(csvFilename, "%s.soak.csv", argv[1]);
+		RunSoakBenchmark(argv[1], argc > 2 ? _atoi64(argv[2]) : soakQueriesPerMap, csvFilename);
+		return 0;
+	}
+	for (int i = 0; i < numSoakMaps; ++i)
+	{
+		char csvFilename[2048];
+		sprintf(csvFilename, "%s.soak.csv", soakMapFilenames[i]);
+		RunSoakBenchmark(soakMapFilenames[i], soakQueriesPerMap, csvFilename);
+	}
+	return 0;
+#endif
+
 	double allTestsTotalTime = 0;
 
 	WIN32_FIND_DATA ffd;
@@ -112,6 +145,8 @@ int _tmain(int argc, char* argv[])
 		char mapFilename[2048] = "\0";
 		char mapScenarioFilename[2048] = "\0";
 		char mapPreprocessedFilename[2048] = "\0";
+		char mapOldFilename[2048] = "\0";
+		char mapOldPreprocessedFilename[2048] = "\0";
 		if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
 		{
 			continue;
@@ -135,6 +170,8 @@ int _tmain(int argc, char* argv[])
 				sprintf(mapFilename, "Maps\\%s", baseFilename);
 				sprintf(mapScenarioFilename, "Maps\\%s.scen", baseFilename);
 				sprintf(mapPreprocessedFilename, "Maps\\%s.pre", baseFilename);
+				sprintf(mapOldFilename, "Maps\\%s.old", baseFilename);
+				sprintf(mapOldPreprocessedFilename, "Maps\\%s.old.pre", baseFilename);
 
 				std::ifstream ifile(mapPreprocessedFilename);
 				pre = !ifile;
@@ -149,9 +186,24 @@ int _tmain(int argc, char* argv[])
 
 		if (pre)
 		{
-			printf("Begin preprocessing map: %s\n", mapFilename);
-			PreprocessMap(mapData, width, height, mapPreprocessedFilename);
-			printf("Done preprocessing map: %s\n", mapFilename);
+			// An edited map can keep its previous version as <map>.old and <map>.old.pre,
+			// then only the goal bounds the edit can change are redone
+			std::vector<bool> oldMapData;
+			int oldWidth = 0, oldHeight = 0;
+			LoadMap(mapOldFilename, oldMapData, oldWidth, oldHeight);
+
+			if (oldWidth == width && oldHeight == height)
+			{
+				printf("Begin incremental preprocessing map: %s\n", mapFilename);
+				PreprocessMapIncremental(oldMapData, mapData, width, height, mapOldPreprocessedFilename, mapPreprocessedFilename);
+				printf("Done incremental preprocessing map: %s\n", mapFilename);
+			}
+			else
+			{
+				printf("Begin preprocessing map: %s\n", mapFilename);
+				PreprocessMap(mapData, width, height, mapPreprocessedFilename);
+				printf("Done preprocessing map: %s\n", mapFilename);
+			}
 		}
 	
 		if (!run)
@@ -199,7 +251,7 @@ int _tmain(int argc, char* argv[])
 		
 		}
 		thePath.clear();
-		delete reference;
+		ReleaseSearch(reference);
 	
 		double totalTime = 0;
 		bool invalid = false;